@@ -0,0 +1,87 @@
+struct Instance {
+	float4x4 model;
+};
+
+struct Draw {
+	float4 sphere; // (x, y, z) -> center, w -> radius, in model space
+	float4 cone; // (x, y, z) -> axis, w -> cutoff, in model space
+	uint instance;
+	uint first_index;
+	uint num_indices;
+	int vertex_offset;
+};
+
+// layout of SDL_GPUIndexedIndirectDrawCommand
+struct IndexedIndirectDrawCommand {
+	uint num_indices;
+	uint num_instances;
+	uint first_index;
+	int vertex_offset;
+	uint first_instance;
+};
+
+StructuredBuffer<Instance> Instances : register(t0, space0);
+StructuredBuffer<Draw> Draws : register(t1, space0);
+// draw slots sorted by material, command i draws Draws[Order[i]]
+StructuredBuffer<uint> Order : register(t2, space0);
+// one bit per instance, set when the instance's bounds passed the BVH's frustum query
+StructuredBuffer<uint> Visibility : register(t3, space0);
+RWStructuredBuffer<IndexedIndirectDrawCommand> Commands : register(u0, space1);
+// triangles of the frame, [0] -> submitted, [1] -> frustum culled, [2] -> backface culled
+RWStructuredBuffer<uint> Stats : register(u1, space1);
+
+cbuffer UBO : register(b0, space2) {
+	float4 planes[6]; // world space frustum planes, normals point inward
+	float3 camera_pos;
+	uint draw_count;
+};
+
+[numthreads(64, 1, 1)]
+void main(uint3 GlobalInvocationID : SV_DispatchThreadID) {
+	uint index = GlobalInvocationID.x;
+	if (index >= draw_count) {
+		return;
+	}
+	Draw draw = Draws[Order[index]];
+	// meshlets of objects the BVH culled skip the per meshlet tests
+	bool in_frustum = ((Visibility[draw.instance >> 5] >> (draw.instance & 31)) & 1) != 0;
+	bool backfacing = false;
+	if (in_frustum) {
+		float4x4 model = Instances[draw.instance].model;
+
+		// move bounding sphere to world space, radius grows with the largest axis scale
+		float3 center = mul(model, float4(draw.sphere.xyz, 1.0f)).xyz;
+		float3 x_axis = model._m00_m10_m20, y_axis = model._m01_m11_m21, z_axis = model._m02_m12_m22;
+		float3 sq_scale = float3(dot(x_axis, x_axis), dot(y_axis, y_axis), dot(z_axis, z_axis));
+		float max_sq_scale = max(sq_scale.x, max(sq_scale.y, sq_scale.z));
+		float radius = draw.sphere.w * sqrt(max_sq_scale);
+
+		for (uint i = 0; i < 6; ++i) {
+			in_frustum = in_frustum && dot(planes[i].xyz, center) + planes[i].w > -radius;
+		}
+		// every triangle faces away from a camera inside the cone behind the meshlet.
+		// Normals only keep their angles under rotation & uniform scale, non-uniform scale or shear
+		// (e.g. a rotated child of a non-uniformly scaled node) bends them out of the cone, so those meshlets aren't cone tested
+		float tolerance = 1e-3f * max_sq_scale;
+		bool conformal = abs(sq_scale.x - sq_scale.y) <= tolerance && abs(sq_scale.x - sq_scale.z) <= tolerance
+			&& abs(dot(x_axis, y_axis)) <= tolerance && abs(dot(x_axis, z_axis)) <= tolerance && abs(dot(y_axis, z_axis)) <= tolerance;
+		float3 axis = normalize(mul((float3x3)model, draw.cone.xyz));
+		float3 view = center - camera_pos;
+		backfacing = conformal && dot(view, axis) >= draw.cone.w * length(view) + radius;
+	}
+	bool visible = in_frustum && !backfacing;
+
+	uint triangles = draw.num_indices / 3;
+	if (triangles > 0) {
+		InterlockedAdd(Stats[visible ? 0 : (in_frustum ? 2 : 1)], triangles);
+	}
+
+	// every command keeps its place in the order, culled draws are issued with zero instances
+	IndexedIndirectDrawCommand command;
+	command.num_indices = draw.num_indices;
+	command.num_instances = visible ? 1 : 0;
+	command.first_index = draw.first_index;
+	command.vertex_offset = draw.vertex_offset;
+	command.first_instance = draw.instance;
+	Commands[index] = command;
+}
@@ -4,6 +4,20 @@ SamplerState ColorSampler : register(s0, space2);
 Texture2D DepthTexture : register(t1, space2);
 SamplerState DepthSampler : register(s1, space2);
 
+// fraction of the textures that was rendered to
+cbuffer UBO : register(b0, space3) {
+    float2 UVScale;
+};
+
+// keep samples inside the rendered area on every side, the rest of the textures is stale
+float2 ClampToRendered(float2 TexCoord)
+{
+    float w, h;
+    DepthTexture.GetDimensions(w, h);
+    float2 half_texel = float2(0.5 / w, 0.5 / h);
+    return clamp(TexCoord, half_texel, UVScale - half_texel);
+}
+
 // Gets the difference between a depth value and adjacent depth pixels
 // This is used to detect "edges", where the depth falls off.
 float GetDifference(float depth, float2 TexCoord, float distance)
@@ -12,18 +26,21 @@ float GetDifference(float depth, float2 TexCoord, float distance)
     DepthTexture.GetDimensions(w, h);
     
     return
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(1.0 / w, 0) * distance).r - depth,
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(-1.0 / w, 0) * distance).r - depth,
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(0, 1.0 / h) * distance).r - depth,
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(0, -1.0 / h) * distance).r - depth, 
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(1.0 / w, -1.0 / h) * distance).r - depth,
-		max(DepthTexture.Sample(DepthSampler, TexCoord + float2(-1.0 / w, 1.0 / h) * distance).r - depth,
-		max(DepthTexture.Sample(DepthSampler, TexCoord + float2(1.0 / w, 1.0 / h) * distance).r - depth,
-		DepthTexture.Sample(DepthSampler, TexCoord + float2(-1.0 / w, -1.0 / h) * distance).r - depth)))))));
+        max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(1.0 / w, 0) * distance)).r - depth,
+        max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(-1.0 / w, 0) * distance)).r - depth,
+        max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(0, 1.0 / h) * distance)).r - depth,
+        max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(0, -1.0 / h) * distance)).r - depth, 
+        max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(1.0 / w, -1.0 / h) * distance)).r - depth,
+		max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(-1.0 / w, 1.0 / h) * distance)).r - depth,
+		max(DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(1.0 / w, 1.0 / h) * distance)).r - depth,
+		DepthTexture.Sample(DepthSampler, ClampToRendered(TexCoord + float2(-1.0 / w, -1.0 / h) * distance)).r - depth)))))));
 }
 
 float4 main(float2 TexCoord : TEXCOORD0) : SV_Target0
 {
+    // window coordinates to the rendered area of the textures
+    TexCoord *= UVScale;
+
     // get our color & depth value
     float4 color = ColorTexture.Sample(ColorSampler, TexCoord);
     float depth = DepthTexture.Sample(DepthSampler, TexCoord).r;
@@ -0,0 +1,38 @@
+struct Instance {
+	float4x4 model;
+};
+
+StructuredBuffer<Instance> Instances : register(t0, space0);
+
+cbuffer UBO : register(b0, space1) {
+	float4x4 proj_view;
+	float position_scale; // undoes normalization of quantized positions
+};
+
+struct Input
+{
+	float3 Position : TEXCOORD0;
+	float3 Normal : TEXCOORD1;
+	// per-instance attribute, equal to the draw's first_instance
+	uint Instance : TEXCOORD2;
+	float2 UV : TEXCOORD3;
+};
+
+struct Output
+{
+	float4 Position : SV_Position;
+	float3 Normal : NORMAL;
+	float4 WorldPos : TEXCOORD1;
+	float2 UV : TEXCOORD2;
+};
+
+Output main(Input input)
+{
+	Output output;
+	float4x4 model = Instances[input.Instance].model;
+	output.WorldPos = mul(model, float4(input.Position * position_scale, 1.0f));
+	output.Position = mul(proj_view, output.WorldPos);
+	output.Normal = normalize(mul((float3x3)model, input.Normal));
+	output.UV = input.UV;
+	return output;
+}
@@ -1,24 +1,12 @@
 # Requires shadercross CLI installed from SDL_shadercross
-for filename in *.vert.hlsl; do
-    if [ -f "$filename" ]; then
-        shadercross "$filename" -o "../bin/SPIRV/${filename/.hlsl/.spv}"
-        shadercross "$filename" -o "../bin/MSL/${filename/.hlsl/.msl}"
-        shadercross "$filename" -o "../bin/DXIL/${filename/.hlsl/.dxil}"
-    fi
-done
-
-for filename in *.frag.hlsl; do
-    if [ -f "$filename" ]; then
-        shadercross "$filename" -o "../bin/SPIRV/${filename/.hlsl/.spv}"
-        shadercross "$filename" -o "../bin/MSL/${filename/.hlsl/.msl}"
-        shadercross "$filename" -o "../bin/DXIL/${filename/.hlsl/.dxil}"
-    fi
-done
-
-for filename in *.comp.hlsl; do
+# writes the binaries & the hash of each source they were compiled from, CMake checks the hashes when configuring
+set -e
+mkdir -p ../bin/sources
+for filename in *.vert.hlsl *.frag.hlsl *.comp.hlsl; do
     if [ -f "$filename" ]; then
         shadercross "$filename" -o "../bin/SPIRV/${filename/.hlsl/.spv}"
         shadercross "$filename" -o "../bin/MSL/${filename/.hlsl/.msl}"
         shadercross "$filename" -o "../bin/DXIL/${filename/.hlsl/.dxil}"
+        cmake -E sha256sum "$filename" | cut -d ' ' -f 1 > "../bin/sources/${filename/.hlsl/.sha256}"
     fi
 done
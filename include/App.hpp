@@ -1,49 +1,56 @@
 #pragma once
+#include <mutex>
+#include <string>
 #include <vector>
 
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_init.h>
 
-#include <fastgltf/core.hpp>
-#include <fastgltf/tools.hpp>
-
+#include "Capture.hpp"
+#include "FramePacer.hpp"
 #include "GPUResources.hpp"
+#include "Jobs.hpp"
+#include "Memory.hpp"
 #include "Pipelines.hpp"
+#include "Profiling.hpp"
+#include "Scene.hpp"
 
-template <>
-struct fastgltf::ElementTraits<glm::vec3>
-: fastgltf::ElementTraitsBase<glm::vec3, AccessorType::Vec3, float> { };
-
-struct GPUBufferAllocationInfo {
-	Uint32 bytes { }, count { };
-	GPUBufferAllocationInfo& operator += (const GPUBufferAllocationInfo &other) {
-		bytes += other.bytes;
-		count += other.count;
-		return *this;
-	}
-};
-struct GeometryAllocationInfo {
-	GPUBufferAllocationInfo indices, verts, norms;
-	GeometryAllocationInfo& operator += (const GeometryAllocationInfo &other) {
-		indices += other.indices;
-		verts += other.verts;
-		norms += other.norms;
-		return *this;
-	}
+struct AppOptions {
+	// capture the composite of every frame to this directory from the start, empty to not capture
+	std::filesystem::path capture_directory;
+	// render to an offscreen composite instead of a window, for benchmarks, no default scene is loaded
+	bool headless { false };
 };
 
 class App {
 public:
 	App() { }
 	~App() { }
-	SDL_AppResult init();
+	// Create the window, device & pipelines
+	SDL_AppResult init(const AppOptions &options = { });
 	void quit();
 	SDL_AppResult iterate();
 	SDL_AppResult event(SDL_Event *e);
 	SDL_AppResult openGLTF();
-	void loadGLTF(const std::filesystem::path &path);
+	// queue a file to be added by the next frame, safe to call from any thread
+	void queueGLTF(const std::filesystem::path &path);
+	// add a file to the scene in front of the camera, returns false if it could not be loaded
+	bool loadGLTF(const std::filesystem::path &path);
+	// remove the most recently added asset
+	void removeGLTF();
+	const Scene& scene() const { return m_scene; }
+	Camera& camera() { return m_camera; }
+	FramePacer& pacer() { return m_pacer; }
+	// skip rendering frames that would draw what color & depth already hold, on by default
+	void elideIdleFrames(const bool &elide) { m_elide_idle = elide; }
+	// cull meshlets in the cull shader, on by default, otherwise on workers with Scene::cullMeshlets
+	void cullOnGpu(const bool &gpu) { m_gpu_culling = gpu; }
 private:
+	// (re)create color & depth targets, sized for the largest render scale
+	bool createTargets();
+	// log the object in the center of the view
+	void pick();
 	SDL_GPUShaderFormat m_supported_formats {
 		SDL_GPU_SHADERFORMAT_SPIRV |
 		SDL_GPU_SHADERFORMAT_DXIL |
@@ -52,15 +59,47 @@ private:
 	SDL_WindowFlags m_window_flags {
 		SDL_WINDOW_RESIZABLE
 	};
-	SDL_GPUDevice *m_gpu;
-	SDL_Window *m_window;
+	SDL_GPUDevice *m_gpu { nullptr };
+	SDL_Window *m_window { nullptr }; // nullptr when headless
+	// stands in for the swapchain when headless, only its format is used otherwise
+	GPUResource<TEXTURE> m_composite;
 	OutlinePipeline m_outline_pipeline;
 	BlinnPhongPipeline m_blinnphong_pipeline;
-	GPUResource<BUFFER> m_i_buf, m_v_buf, m_norm_buf;
+	CullPipeline m_cull_pipeline;
+	JobSystem m_jobs;
+	Scene m_scene;
+	// assets in the order they were added, the last one is removed first
+	std::vector<AssetHandle> m_assets;
+	// files picked in the dialog, which may call back from another thread
+	std::mutex m_pending_mutex;
+	std::vector<std::filesystem::path> m_pending_loads;
 	GPUResource<TEXTURE> m_color, m_depth;
+	FramePacer m_pacer;
+	ResolutionGovernor m_governor;
+	FrameStats m_stats;
+	FrameCapture m_capture;
+	// transient lists of the frame being recorded
+	FrameArena m_frame_arena;
+	// signaled when a frame's commands finish, indexed by frame % max_frames_in_flight,
+	// waited on FramePacer::framesInFlight frames later
+	SDL_GPUFence *m_fences[FramePacer::max_frames_in_flight] { };
+	Uint64 m_frame_index { 0 }, m_last_frame_start { 0 };
+	// what color & depth currently hold, frames that would render the same are elided
+	struct RenderedState {
+		glm::mat4 proj_view { 0 };
+		Uint64 scene_revision { 0 };
+		Uint32 width { 0 }, height { 0 };
+	} m_rendered;
+	bool m_targets_dirty { true };
+	// the last frame only redid the composite
+	bool m_idle { false };
+	bool m_elide_idle { true };
+	bool m_gpu_culling { true };
+	// triangles culled on the cpu by the current frame
+	CullPipeline::CullStats m_cpu_cull_stats { };
+	static constexpr Sint32 idle_timeout_ms { 100 };
 
 	Uint32 m_width { 1200 }, m_height { 900 };
-	std::vector<Mesh> m_objects;
 	Camera m_camera {
 		{-40, 40, -40},
 		glm::quat_cast(glm::lookAt(glm::vec3{-40, 40, -40}, {0, 0, 0}, {0, 1, 0})),
@@ -0,0 +1,110 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Jobs.hpp"
+
+// axis aligned bounding box, empty until something is added
+struct AABB {
+	glm::vec3 min { std::numeric_limits<float>::max() };
+	glm::vec3 max { std::numeric_limits<float>::lowest() };
+	void grow(const glm::vec3 &point);
+	void grow(const AABB &other);
+	bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+	glm::vec3 center() const { return (min + max) * 0.5f; }
+	// half of the surface area, the SAH only compares areas
+	float area() const;
+	// box enclosing this one after transform
+	AABB transformed(const glm::mat4 &transform) const;
+};
+
+// Bounding volume hierarchy over a set of boxes
+// built top down with a binned surface area heuristic, subtrees above a size are built in parallel.
+// Refit keeps the tree & only recomputes bounds, good enough while primitives move less than their size.
+// Insert & remove change one leaf & the boxes above it, the tree drifts from what a build would make,
+// callers rebuild once they changed about as many primitives as the tree holds.
+class BVH {
+public:
+	struct Node {
+		AABB bounds;
+		Uint32 first; // interior -> left child, the right child follows it, leaf -> first entry of indices
+		Uint32 count; // primitives in a leaf, 0 for interior nodes
+	};
+	struct Hit {
+		Uint32 primitive;
+		float t; // distance along the ray in units of its direction
+	};
+	// refines a hit at distance t_box on a primitive's box, returns the distance to the exact hit or std::nullopt for a miss
+	using ExactTest = std::function<std::optional<float>(const Uint32 &primitive, const float &t_box, const float &t_max)>;
+	/**
+	 * Build the tree, empty boxes are left out
+	 *
+	 * @param bounds Box of every primitive, indexed by primitive
+	 * @param jobs Job system to build subtrees on, nullptr builds on the calling thread
+	 */
+	void build(std::span<const AABB> bounds, JobSystem *jobs = nullptr);
+	// recompute the bounds of every node for moved primitives, the tree is kept
+	void refit(std::span<const AABB> bounds);
+	/**
+	 * Add a primitive to the leaf whose box grows least, an empty box is left out
+	 *
+	 * @param primitive Index of the primitive, replaces it if it is in the tree already
+	 * @param box Its box
+	 */
+	void insert(const Uint32 &primitive, const AABB &box);
+	// take a primitive out of its leaf, a leaf left empty is replaced by its sibling
+	void remove(const Uint32 &primitive);
+	/**
+	 * Find the closest primitive along a ray
+	 *
+	 * @param origin Start of the ray
+	 * @param direction Direction of the ray, distances are in its units
+	 * @param t_max Hits further than this are ignored
+	 * @param exact Test against the primitive itself, without it the primitive's box is hit
+	 */
+	std::optional<Hit> raycast(const glm::vec3 &origin, const glm::vec3 &direction, float t_max = std::numeric_limits<float>::max(), const ExactTest &exact = { }) const;
+	/**
+	 * Collect primitives whose boxes intersect a frustum,
+	 * subtrees inside every plane are taken whole without testing their children
+	 *
+	 * @param planes (normal, distance) with normals pointing inward, see Camera::frustum
+	 * @param visible Primitives are appended here
+	 */
+	void frustum(const std::array<glm::vec4, 6> &planes, std::pmr::vector<Uint32> &visible) const;
+	bool empty() const { return m_nodes.empty(); }
+	// number of primitives in the tree
+	Uint32 size() const { return m_size; }
+	const std::vector<Node>& nodes() const { return m_nodes; }
+	static constexpr Uint32 bins { 16 };
+	// leaves are split until they are this small or splitting costs more than it saves
+	static constexpr Uint32 min_leaf { 2 }, max_leaf { 8 };
+	// subtrees with more primitives than this are built as their own job
+	static constexpr Uint32 parallel_size { 4096 };
+private:
+	// build the subtree of node over indices [begin, end)
+	void buildNode(const Uint32 &node, const Uint32 &begin, const Uint32 &end, std::span<const AABB> bounds, std::atomic<Uint32> &node_count, JobSystem *jobs);
+	// recompute the box of a node from its entries or children
+	void refitNode(const Uint32 &node);
+	static constexpr Uint32 none { ~0u };
+	std::vector<Node> m_nodes; // the root is first, children always come after their parent
+	std::vector<Uint32> m_parents; // of every node, none for the root
+	// primitives in leaf order, every subtree of a build covers a contiguous range,
+	// inserts are appended & removes leave entries no leaf covers until the next build
+	std::vector<Uint32> m_indices;
+	std::vector<AABB> m_bounds; // boxes of m_indices, leaves test them without touching the caller's data
+	std::vector<Uint32> m_leaves; // leaf of every entry of m_indices
+	std::vector<Uint32> m_entries; // entry of every primitive in m_indices, none if it isn't in the tree
+	Uint32 m_size { 0 };
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#include <filesystem>
+#include <vector>
+
+// Headless benchmarks, run from the command line instead of opening a window
+
+// build, refit & query BVHs over 10k to 1M random boxes, returns false if a query disagrees with a linear scan
+bool benchmarkBVH();
+// submit, steal & continuation overhead & parallelFor scaling on 1 to 32 workers, returns false if a job ran twice, never or out of order
+bool benchmarkJobs();
+
+struct SceneBenchmark {
+	std::filesystem::path scene;
+	// results to compare against, the benchmark is skipped while it is missing & written only when update_baseline is set
+	std::filesystem::path baseline;
+	Uint32 frames { 300 };
+	float threshold { 0.2f }; // fraction over the baseline that counts as a regression
+	bool update_baseline { false };
+	// load the scene again with application logs at info & at debug priority, as SDL_LOGGING=app=debug would
+	bool compare_log_priority { false };
+};
+// result of a benchmark that couldn't run on this machine, e.g. without a gpu
+constexpr const char *benchmark_skipped { "Benchmark skipped" };
+/**
+ * Orbit each scene with meshlets culled on the gpu, then on the cpu, & log which scenes culling on the gpu is faster for
+ *
+ * @param scenes Scenes of increasing object counts
+ * @param frames Frames of each orbit
+ * @return false if a scene could not be loaded or rendered
+ */
+bool benchmarkCulling(const std::vector<std::filesystem::path> &scenes, const Uint32 &frames);
+/**
+ * Load a scene into a headless App & run its frames with a camera orbiting it,
+ * then hold the camera still at 60 fps with & without idle frame elision.
+ * Load time, peak resident memory, wall & cpu time per frame & cpu time per second of the still camera
+ * are compared against the baseline
+ *
+ * @param options The scene, its baseline & how many frames to run
+ * @return false if loading failed or a result regressed past the threshold
+ */
+bool benchmarkScene(const SceneBenchmark &options);
@@ -0,0 +1,92 @@
+#pragma once
+#include <SDL3/SDL_gpu.h>
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+
+#include "GPUResources.hpp"
+#include "Jobs.hpp"
+
+// what a capture downloads each frame
+enum class CaptureSource {
+	composite, // the window's image, outlines included
+	color, // the scaled render area of the color target
+};
+
+// Captures rendered frames to PNG files without stalling the frame loop
+// each capture downloads into a free slot of a ring of transfer buffers on its own command buffer,
+// its fence is polled at the start of later frames & the mapped pixels are encoded on the background thread.
+// A frame that finds every slot busy is dropped, rendering never waits on the disk.
+class FrameCapture {
+public:
+	/**
+	 * Initialize capture
+	 *
+	 * @param gpu A valid GPUDevice handle
+	 * @param jobs Job system to encode frames on in the background
+	 */
+	void init(SDL_GPUDevice *gpu, JobSystem *jobs);
+	// finish every capture in flight & release the ring
+	void quit();
+	/**
+	 * Capture every frame from now on
+	 *
+	 * @param directory Where frame_<index>.png files are written, created if missing
+	 * @param source The texture to download each frame
+	 */
+	bool start(const std::filesystem::path &directory, const CaptureSource &source);
+	// stop capturing, captures in flight are still written
+	void stop();
+	bool active() const { return m_active; }
+	CaptureSource source() const { return m_source; }
+	/**
+	 * Offscreen texture to composite into while capturing the composite, blitted to the window afterwards
+	 *
+	 * @param width Width of the window
+	 * @param height Height of the window
+	 * @param format Format of the window's swapchain
+	 * @return The texture, nullptr if it could not be created
+	 */
+	SDL_GPUTexture* target(const Uint32 &width, const Uint32 &height, const SDL_GPUTextureFormat &format);
+	/**
+	 * Download a texture once the frame's commands are done, call after the frame is submitted
+	 *
+	 * @param texture The texture to download
+	 * @param format Format of texture, 4 byte RGBA & BGRA formats are supported
+	 * @param width Width of the area to download, from the top left corner
+	 * @param height Height of the area to download
+	 * @param frame Index of the frame, names the file
+	 */
+	void capture(SDL_GPUTexture *texture, const SDL_GPUTextureFormat &format, const Uint32 &width, const Uint32 &height, const Uint64 &frame);
+	/**
+	 * Hand finished downloads to encode jobs & recycle slots whose file was written, never blocks
+	 *
+	 * @return Frames written since the last call
+	 */
+	Uint32 poll();
+	// frames dropped since the last call because every slot was busy
+	Uint32 dropped();
+	static constexpr Uint32 ring_size { 4 };
+private:
+	struct Slot {
+		enum class State { free, downloading, encoding } state { State::free };
+		GPUResource<TRANSFER_BUFFER> buffer;
+		SDL_GPUFence *fence { nullptr }; // signaled once the download is done
+		JobHandle encode;
+		const Uint8 *pixels { nullptr }; // mapped while encoding
+		SDL_GPUTextureFormat format;
+		Uint32 width, height;
+		Uint64 frame;
+		std::atomic<bool> written { false };
+	};
+	SDL_GPUDevice *m_gpu { nullptr };
+	JobSystem *m_jobs { nullptr };
+	bool m_active { false };
+	CaptureSource m_source { CaptureSource::composite };
+	std::filesystem::path m_directory;
+	GPUResource<TEXTURE> m_target;
+	// GPUResource can't be moved, slots stay in place
+	std::array<Slot, ring_size> m_slots;
+	Uint32 m_dropped { 0 };
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_video.h>
+
+// Paces the main loop
+// simulation runs at a fixed rate regardless of the frame rate, rendering interpolates between ticks.
+// Presentation is configured through the swapchain's present mode & the number of frames in flight,
+// an optional frame rate cap sleeps the remainder of each frame to bound cpu use.
+class FramePacer {
+public:
+	/**
+	 * Apply the initial present mode & frames in flight
+	 *
+	 * @param gpu A valid GPUDevice handle
+	 * @param window The window claimed by gpu, nullptr when rendering offscreen where only frames in flight & the cap apply
+	 */
+	bool init(SDL_GPUDevice *gpu, SDL_Window *window);
+	// sleep until the next frame is due when the frame rate is capped
+	void limit();
+	/**
+	 * Advance the simulation clock to now
+	 *
+	 * @return The number of fixed ticks to simulate this frame
+	 */
+	Uint32 advance();
+	// position between the last two ticks to render at, in [0, 1]
+	float alpha() const { return static_cast<float>(m_accumulator) / tick_ns; }
+	// switch to the next supported present mode
+	void cyclePresentMode();
+	// switch between 1 & max_frames_in_flight frames in flight
+	void cycleFramesInFlight();
+	Uint32 framesInFlight() const { return m_frames_in_flight; }
+	// switch between uncapped & capped frame rates
+	void cycleFrameCap();
+	// cap the frame rate, 0 for uncapped
+	void setFrameCap(const Uint32 &fps);
+	/**
+	 * Record an input event, latency is measured from the oldest input not yet submitted
+	 *
+	 * @param timestamp The event's timestamp in nanoseconds
+	 */
+	void input(const Uint64 &timestamp);
+	/**
+	 * Record that the frame's commands were submitted
+	 *
+	 * @return Time since the oldest input the frame responds to in ms, 0 if there was no input
+	 */
+	float submitted();
+	static constexpr Uint64 tick_ns { SDL_NS_PER_SECOND / 60 };
+	// ticks simulated at most per frame, long stalls slow down the simulation instead of freezing it
+	static constexpr Uint32 max_ticks { 8 };
+	// per-frame resources that outlive recording (fences, readbacks) are sized for this many frames
+	static constexpr Uint32 max_frames_in_flight { 3 };
+private:
+	bool apply();
+	SDL_GPUDevice *m_gpu { nullptr };
+	SDL_Window *m_window { nullptr };
+	SDL_GPUPresentMode m_present_mode { SDL_GPU_PRESENTMODE_VSYNC };
+	Uint32 m_frames_in_flight { 2 };
+	Uint32 m_fps_cap { 0 }; // 0 -> uncapped
+	Uint64 m_next_frame { 0 };
+	Uint64 m_last_advance { 0 }, m_accumulator { 0 };
+	Uint64 m_oldest_input { 0 };
+};
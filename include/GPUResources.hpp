@@ -10,8 +10,13 @@ enum RESOURCE_TYPES {
 	BUFFER,
 	TRANSFER_BUFFER,
 	SHADER,
-	GRAPHICS_PIPELINE
+	GRAPHICS_PIPELINE,
+	COMPUTE_PIPELINE
 };
+constexpr Uint32 resource_type_count { COMPUTE_PIPELINE + 1 };
+
+// bytes of every mip level & layer of a texture
+Uint64 textureBytes(const SDL_GPUTextureCreateInfo &info);
 
 // define create & release function for 
 // objects that must be released
@@ -23,6 +28,7 @@ template<> struct GPUResourceTraits<TEXTURE> {
 	static constexpr auto description = "Texture";
 	static constexpr auto create = SDL_CreateGPUTexture;
 	static constexpr auto release = SDL_ReleaseGPUTexture;
+	static Uint64 bytes(const info &create_info) { return textureBytes(create_info); }
 };
 template<> struct GPUResourceTraits<SAMPLER> {
 	using info = SDL_GPUSamplerCreateInfo;
@@ -30,6 +36,7 @@ template<> struct GPUResourceTraits<SAMPLER> {
 	static constexpr auto description = "Sampler";
 	static constexpr auto create = SDL_CreateGPUSampler;
 	static constexpr auto release = SDL_ReleaseGPUSampler;
+	static Uint64 bytes(const info&) { return 0; }
 };
 template<> struct GPUResourceTraits<BUFFER> {
 	using info = SDL_GPUBufferCreateInfo;
@@ -37,6 +44,7 @@ template<> struct GPUResourceTraits<BUFFER> {
 	static constexpr auto description = "Buffer";
 	static constexpr auto create = SDL_CreateGPUBuffer;
 	static constexpr auto release = SDL_ReleaseGPUBuffer;
+	static Uint64 bytes(const info &create_info) { return create_info.size; }
 };
 template<> struct GPUResourceTraits<SHADER> {
 	using info = SDL_GPUShaderCreateInfo;
@@ -44,6 +52,7 @@ template<> struct GPUResourceTraits<SHADER> {
 	static constexpr auto description = "Shader";
 	static constexpr auto create = SDL_CreateGPUShader;
 	static constexpr auto release = SDL_ReleaseGPUShader;
+	static Uint64 bytes(const info&) { return 0; }
 };
 template<> struct GPUResourceTraits<GRAPHICS_PIPELINE> {
 	using info = SDL_GPUGraphicsPipelineCreateInfo;
@@ -51,6 +60,15 @@ template<> struct GPUResourceTraits<GRAPHICS_PIPELINE> {
 	static constexpr auto description = "Graphics Pipeline";
 	static constexpr auto create = SDL_CreateGPUGraphicsPipeline;
 	static constexpr auto release = SDL_ReleaseGPUGraphicsPipeline;
+	static Uint64 bytes(const info&) { return 0; }
+};
+template<> struct GPUResourceTraits<COMPUTE_PIPELINE> {
+	using info = SDL_GPUComputePipelineCreateInfo;
+	using type = SDL_GPUComputePipeline;
+	static constexpr auto description = "Compute Pipeline";
+	static constexpr auto create = SDL_CreateGPUComputePipeline;
+	static constexpr auto release = SDL_ReleaseGPUComputePipeline;
+	static Uint64 bytes(const info&) { return 0; }
 };
 template<> struct GPUResourceTraits<TRANSFER_BUFFER> {
 	using info = SDL_GPUTransferBufferCreateInfo;
@@ -58,8 +76,33 @@ template<> struct GPUResourceTraits<TRANSFER_BUFFER> {
 	static constexpr auto description = "Transfer Buffer";
 	static constexpr auto create = SDL_CreateGPUTransferBuffer;
 	static constexpr auto release = SDL_ReleaseGPUTransferBuffer;
+	static Uint64 bytes(const info &create_info) { return create_info.size; }
 };
 
+// live objects & bytes of one resource type, with the most there were at once
+struct GPUResourceStats {
+	Uint32 live { 0 }, max_live { 0 };
+	Uint64 bytes { 0 }, max_bytes { 0 };
+	Uint64 created { 0 }, failed { 0 }; // since the program started
+};
+
+// Tracks every GPUResource by type, on any thread
+// bytes come from the create info, objects without memory of their own
+// (samplers, shaders & pipelines) count 0 bytes.
+// Creates & releases that succeed only log at debug priority, e.g. with SDL_LOGGING=app=debug
+namespace GPUResourceRegistry {
+	void created(const RESOURCE_TYPES &type, const Uint64 &bytes);
+	void failed(const RESOURCE_TYPES &type);
+	void released(const RESOURCE_TYPES &type, const Uint64 &bytes);
+	GPUResourceStats stats(const RESOURCE_TYPES &type);
+	// bytes of every live resource
+	Uint64 liveBytes();
+	// log the live objects & bytes of every type with their high-water marks
+	void log();
+	// log every type with objects still alive, returns false if there are any
+	bool reportLeaks();
+}
+
 // A GPUResource will automatically get the create & release function from GPUResourceTraits
 template<RESOURCE_TYPES TYPE> class GPUResource {
 public:
@@ -74,8 +117,11 @@ public:
 		ptr = GPUResourceTraits<TYPE>::create(gpu, &info);
 		if (!ptr) {
 			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Creating %s - Fail!\n\t%s", GPUResourceTraits<TYPE>::description, SDL_GetError());
+			GPUResourceRegistry::failed(TYPE);
 		} else {
-			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Creating %s - Success!", GPUResourceTraits<TYPE>::description);
+			bytes = GPUResourceTraits<TYPE>::bytes(info);
+			GPUResourceRegistry::created(TYPE, bytes);
+			SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Creating %s - Success! (%llu bytes)", GPUResourceTraits<TYPE>::description, static_cast<unsigned long long>(bytes));
 		}
 		return ptr;
 	}
@@ -88,8 +134,11 @@ public:
 			return;
 		}
 		GPUResourceTraits<TYPE>::release(gpu, ptr); 
+		GPUResourceRegistry::released(TYPE, bytes);
 		gpu = nullptr;
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released %s", GPUResourceTraits<TYPE>::description);
+		ptr = nullptr;
+		bytes = 0;
+		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "Released %s", GPUResourceTraits<TYPE>::description);
 	}
 	GPUResourceTraits<TYPE>::type* get() const { return ptr; }
 	GPUResource(const GPUResource &other) = delete;
@@ -97,8 +146,35 @@ public:
 	GPUResource<TYPE>& operator=(const GPUResource<TYPE>&) = delete;
 	GPUResource<TYPE>& operator=(const GPUResource<TYPE>&&) = delete;
 private:
-	GPUResourceTraits<TYPE>::type *ptr;
-	SDL_GPUDevice *gpu;
+	GPUResourceTraits<TYPE>::type *ptr { nullptr };
+	SDL_GPUDevice *gpu { nullptr };
+	// bytes counted by the registry, info can change before release
+	Uint64 bytes { 0 };
+};
+
+// A buffer that keeps its contents when it grows
+// growing creates a buffer at least twice as large & copies the old contents on the gpu
+class GPUGrowableBuffer {
+public:
+	GPUGrowableBuffer() { }
+	~GPUGrowableBuffer() { }
+	SDL_GPUBufferUsageFlags usage { 0 };
+	/**
+	 * Make sure the buffer holds at least bytes
+	 *
+	 * @param gpu A valid GPUDevice handle
+	 * @param copypass The copy pass to copy the old contents in, nullptr to discard them
+	 * @param bytes The minimum size in bytes
+	 * @return false if a larger buffer could not be created
+	 */
+	bool reserve(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copypass, const Uint32 &bytes);
+	void release();
+	SDL_GPUBuffer* get() const { return m_buffers[m_current].get(); }
+	Uint32 size() const { return get() ? m_buffers[m_current].info.size : 0; }
+private:
+	// GPUResource can't be moved, the larger buffer is created in the other slot
+	GPUResource<BUFFER> m_buffers[2];
+	Uint32 m_current { 0 };
 };
 
 // helper functions
@@ -106,3 +182,6 @@ private:
 // if successful, the return value is also stored within the GPUResource
 // otherwise, the GPUResource remains untouched
 SDL_GPUShader* createShader(SDL_GPUDevice *gpu, GPUResource<SHADER> *shader, const std::string &filename, const Uint32 &num_samplers, const Uint32 &num_storage_textures, const Uint32 &num_storage_buffers, const Uint32 &num_uniform_buffers);
+// returns nullptr on failure, valid SDL_GPUComputePipeline* otherwise
+// compute pipelines are created directly from shader code, there is no intermediate SDL_GPUShader
+SDL_GPUComputePipeline* createComputePipeline(SDL_GPUDevice *gpu, GPUResource<COMPUTE_PIPELINE> *pipeline, const std::string &filename, const Uint32 &num_readonly_storage_buffers, const Uint32 &num_readwrite_storage_buffers, const Uint32 &num_uniform_buffers, const Uint32 &threadcount_x);
@@ -0,0 +1,168 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Move-only void() callable stored inline, std::function allocates for captures past its small buffer
+// & submitting every frame shouldn't touch the heap
+class JobTask {
+public:
+	static constexpr std::size_t capacity { 64 };
+	JobTask() { }
+	template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, JobTask>>>
+	JobTask(F &&function) {
+		using Stored = std::decay_t<F>;
+		static_assert(sizeof(Stored) <= capacity, "Job captures too much, capture a pointer to the state instead");
+		static_assert(alignof(Stored) <= alignof(std::max_align_t), "Job capture is over aligned");
+		new (m_storage) Stored(std::forward<F>(function));
+		m_call = [](void *storage) { (*std::launder(static_cast<Stored*>(storage)))(); };
+		m_relocate = [](void *from, void *to) {
+			Stored *stored { std::launder(static_cast<Stored*>(from)) };
+			if (to) { new (to) Stored(std::move(*stored)); }
+			stored->~Stored();
+		};
+	}
+	JobTask(JobTask &&other) noexcept { *this = std::move(other); }
+	JobTask& operator=(JobTask &&other) noexcept {
+		if (this == &other) { return *this; }
+		reset();
+		if (other.m_relocate) {
+			other.m_relocate(other.m_storage, m_storage);
+			m_call = std::exchange(other.m_call, nullptr);
+			m_relocate = std::exchange(other.m_relocate, nullptr);
+		}
+		return *this;
+	}
+	JobTask(const JobTask&) = delete;
+	JobTask& operator=(const JobTask&) = delete;
+	~JobTask() { reset(); }
+	void operator()() { m_call(m_storage); }
+	explicit operator bool() const { return m_call != nullptr; }
+	// destroy the captures
+	void reset() {
+		if (m_relocate) { m_relocate(m_storage, nullptr); }
+		m_call = nullptr;
+		m_relocate = nullptr;
+	}
+private:
+	alignas(std::max_align_t) std::byte m_storage[capacity];
+	void (*m_call)(void*) { nullptr };
+	// move constructs into to & destroys from, only destroys if to is nullptr
+	void (*m_relocate)(void *from, void *to) { nullptr };
+};
+
+// A unit of work scheduled on a JobSystem
+struct Job {
+	JobTask task;
+	// unfinished dependencies, +1 while the job is being submitted
+	std::atomic<Uint32> pending { 1 };
+	std::atomic<bool> done { false };
+	// jobs waiting on this one, guarded by mutex
+	// the first few are stored inline so adding a dependency edge doesn't allocate
+	static constexpr Uint32 inline_continuations { 4 };
+	std::mutex mutex;
+	std::array<std::shared_ptr<Job>, inline_continuations> continuations;
+	Uint32 num_continuations { 0 };
+	std::vector<std::shared_ptr<Job>> overflow;
+};
+using JobHandle = std::shared_ptr<Job>;
+
+// Work-stealing scheduler
+// every worker owns a deque: it pushes & pops at the back,
+// idle workers steal from the front of the others.
+// Threads that are not workers (e.g. the main thread) share the first deque
+// and help execute jobs while they wait.
+// Background jobs (disk io, encoding, transcoding) run on a thread of their own,
+// wait never picks them up so they can't stall a frame.
+class JobSystem {
+public:
+	JobSystem() { }
+	// joins workers that are still running, e.g. when the app failed to init after starting them
+	~JobSystem() { quit(); }
+	/**
+	 * Start worker threads
+	 *
+	 * @param num_workers The number of threads to spawn, 0 picks one per logical core minus the caller
+	 */
+	void init(Uint32 num_workers = 0);
+	// finish queued jobs & join worker threads, does nothing if they aren't running
+	void quit();
+	/**
+	 * Schedule a task
+	 *
+	 * @param task The work to run
+	 * @param dependencies Jobs that must finish before task starts, task becomes their continuation
+	 * @return Handle to wait on or to pass as a dependency
+	 */
+	JobHandle submit(JobTask task, std::span<const JobHandle> dependencies = { });
+	/**
+	 * Schedule a task on the background thread, in submission order
+	 *
+	 * @param task The work to run, it may block or take longer than a frame
+	 * @return Handle to poll or to wait on, waiting blocks until the background thread gets to it
+	 */
+	JobHandle submitBackground(JobTask task);
+	// block until job is done, running other jobs in the meantime
+	void wait(const JobHandle &job);
+	/**
+	 * Split [0, count) into chunks of at most grain elements and run them in parallel,
+	 * returns once every chunk is done
+	 *
+	 * @param count The number of elements
+	 * @param grain The maximum number of elements per job
+	 * @param body Called with each chunk's [begin, end)
+	 */
+	template<typename Body>
+	void parallelFor(Uint32 count, Uint32 grain, const Body &body) {
+		parallelFor(count, grain, [](const void *context, Uint32 begin, Uint32 end) {
+			(*static_cast<const Body*>(context))(begin, end);
+		}, &body);
+	}
+	// number of threads executing jobs, including the caller of wait
+	Uint32 concurrency() const { return static_cast<Uint32>(m_queues.size()); }
+private:
+	// ring buffer of jobs, it only allocates when it grows
+	struct Queue {
+		std::mutex mutex;
+		std::vector<JobHandle> ring;
+		Uint32 head { 0 }, count { 0 };
+		void pushBack(JobHandle job);
+		JobHandle popBack();
+		JobHandle popFront();
+	};
+	// body is called through a plain function pointer, wrapping it in a std::function could allocate
+	void parallelFor(Uint32 count, Uint32 grain, void (*body)(const void *context, Uint32 begin, Uint32 end), const void *context);
+	void worker(Uint32 index);
+	void backgroundWorker();
+	// push a job whose dependencies are done to the calling thread's deque
+	void schedule(JobHandle job);
+	// pop from the calling thread's deque, otherwise steal, returns nullptr if there is no work
+	JobHandle next();
+	void execute(const JobHandle &job);
+	// finished jobs are returned here & reused, submitting doesn't allocate once the pool is warm
+	std::pmr::synchronized_pool_resource m_job_pool;
+	std::vector<std::unique_ptr<Queue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<Uint32> m_queued { 0 };
+	std::atomic<bool> m_running { false };
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_wake;
+	// first in first out, only the background thread pops
+	std::deque<JobHandle> m_background;
+	std::thread m_background_thread;
+	std::mutex m_background_mutex;
+	std::condition_variable m_background_wake;
+};
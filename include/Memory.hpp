@@ -0,0 +1,31 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// number of heap allocations made through operator new since the program started, on every thread
+Uint64 heapAllocations();
+// most memory the process had resident at once in bytes, 0 where it can't be queried
+Uint64 peakResidentBytes();
+
+// Linear allocator for data that lives for one frame
+// allocations bump an offset through one block & deallocation does nothing,
+// reset() rewinds the whole block at the start of the next frame.
+// A frame that doesn't fit spills to the heap, the block grows to fit it at the next reset.
+class FrameArena : public std::pmr::memory_resource {
+public:
+	explicit FrameArena(const std::size_t &capacity = 64 * 1024) : m_block(capacity) { }
+	// forget every allocation of the last frame
+	void reset();
+	// bytes handed out since the last reset
+	std::size_t used() const { return m_used + m_spilled; }
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void*, std::size_t, std::size_t) override { }
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+	std::vector<std::byte> m_block;
+	std::size_t m_used { 0 }, m_spilled { 0 };
+	std::pmr::monotonic_buffer_resource m_spill;
+};
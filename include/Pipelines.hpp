@@ -6,20 +6,49 @@
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <array>
+#include <deque>
+#include <optional>
+
+#include "FramePacer.hpp"
 #include "GPUResources.hpp"
 
+class Scene;
+
 struct Mesh {
-	glm::vec3 pos, scale;
-	glm::quat rot;
-	Uint32 num_indices, first_index;
+	glm::mat4x4 transform; // node transform within its asset, including parent nodes
+	glm::vec3 min, max; // model space bounds of all primitives
+	Uint32 num_draws; // meshlets drawn for this mesh, 0 once its asset is removed
+	Uint32 asset; // handle of the asset the mesh belongs to
 	glm::mat4x4 model_mat() const;
 };
 
+// per-mesh data read by the cull & geometry shaders, see Instance in Cull.comp.hlsl
+struct GPUInstance {
+	glm::mat4 model;
+};
+
+// one indexed draw per meshlet, see Draw in Cull.comp.hlsl
+struct GPUDraw {
+	glm::vec4 sphere; // (x, y, z) -> center, w -> radius, in model space
+	glm::vec4 cone; // (x, y, z) -> axis, w -> cutoff, the meshlet faces away from views inside the cone
+	Uint32 instance, first_index, num_indices;
+	Sint32 vertex_offset;
+};
+
 struct Camera {
 	Camera(const glm::vec3 &t_pos, const glm::quat &t_rot, const glm::vec2 &t_dimensions)
-	: pos(t_pos), rot(t_rot), dimensions(t_dimensions) { }
-	// update camera position
+	: pos(t_pos), rot(t_rot), dimensions(t_dimensions), m_prev_pos(t_pos), m_sim_pos(t_pos) { }
+	// advance camera movement by one fixed tick of FramePacer::tick_ns
 	void iterate();
+	/**
+	 * Place the camera between its last two ticks, rotation follows input directly
+	 *
+	 * @param alpha The fraction of a tick since the last one, from FramePacer::alpha
+	 */
+	void interpolate(const float &alpha);
+	// move the camera without interpolating from where it was, e.g. for scripted benchmark paths
+	void place(const glm::vec3 &t_pos, const glm::quat &t_rot);
 	/**
 	 * Update camera based on event 
 	 *
@@ -31,18 +60,36 @@ struct Camera {
 	// returns projection matrix of camera
 	glm::mat4 proj() const;
 	glm::vec3 forward() const;
+	// returns world space direction of the ray from pos through ndc, (0, 0) is the center of the view
+	glm::vec3 ray(const glm::vec2 &ndc) const;
 	// returns up direction of camera
 	glm::vec3 up() const;
 	// returns right direction of camera
 	glm::vec3 right() const;
-	glm::vec3 pos; // (x, y, z) in world space
+	// returns world space frustum planes (left, right, bottom, top, near, far)
+	// as (normal, distance) with normals pointing inward
+	std::array<glm::vec4, 6> frustum() const;
+	glm::vec3 pos; // (x, y, z) in world space, interpolated for rendering
 	glm::quat rot;
 	glm::vec2 dimensions; // (x, y) -> (width, height)
 	glm::vec3 vel { 0, 0, 0 }; // (x, y, z) in world space
 	const float speed { 0.5 };
 	glm::vec2 near_far { 0.1, 1000 }; // (x, y) -> (near, far)
 private:
-	std::unordered_map<SDL_Scancode, bool> m_keys;
+	std::array<bool, SDL_SCANCODE_COUNT> m_keys { }; // held keys, indexed by scancode
+	// simulated positions of the previous & latest tick
+	glm::vec3 m_prev_pos, m_sim_pos;
+};
+
+// formats of the geometry buffers, quantized attributes stay compact on the gpu
+struct VertexLayout {
+	SDL_GPUVertexElementFormat position { SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3 };
+	SDL_GPUVertexElementFormat normal { SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3 };
+	Uint32 position_pitch { sizeof(glm::vec3) }, normal_pitch { sizeof(glm::vec3) };
+	// normalized formats read positions in [-1, 1], this scales them back to the accessor's range
+	float position_scale { 1 };
+	SDL_GPUIndexElementSize index_size { SDL_GPU_INDEXELEMENTSIZE_16BIT };
+	bool operator==(const VertexLayout &other) const = default;
 };
 
 class BlinnPhongPipeline {
@@ -62,18 +109,30 @@ public:
 	 * @param cmdbuf The command buffer associated with this render pass
 	 * @param color Color texture for render output
 	 * @param depth Depth texture for render output
+	 * @param viewport The area of color & depth to render to, smaller than the textures when the resolution is scaled
 	 * @param camera The perspective to render from
-	 * @param TRS_data A vector of meshes to render
-	 * @param indices A buffer of vertex indices that correspond to the meshes
-	 * @param verts A buffer of vertex positions that correspond to the meshes
-	 * @param norms A buffer of vertex normals that correspond to the meshes
+	 * @param scene The geometry pools to draw, with commands written by CullPipeline
 	 */
-	void render(SDL_GPUCommandBuffer *cmdbuf, const GPUResource<TEXTURE> &color, const GPUResource<TEXTURE> &depth, const Camera &camera, const std::vector<Mesh> &TRS_data, const GPUResource<BUFFER> &indices, const GPUResource<BUFFER> &verts, const GPUResource<BUFFER> &norms);
+	void render(SDL_GPUCommandBuffer *cmdbuf, const GPUResource<TEXTURE> &color, const GPUResource<TEXTURE> &depth, const SDL_GPUViewport &viewport, const Camera &camera, const Scene &scene);
 private:
-	GPUResource<GRAPHICS_PIPELINE> m_pipeline;
+	// upload the white texture bound for materials without a resident texture
+	bool createWhiteTexture();
+	// returns the pipeline for layout, created on first use
+	SDL_GPUGraphicsPipeline* pipelineFor(const VertexLayout &layout);
+	SDL_GPUDevice *m_gpu;
+	struct LayoutPipeline {
+		VertexLayout layout;
+		GPUResource<GRAPHICS_PIPELINE> pipeline;
+	};
+	// one pipeline per vertex layout in the scene, deque as GPUResource can't be moved
+	std::deque<LayoutPipeline> m_pipelines;
+	// kept alive to create pipelines for new layouts
 	GPUResource<SHADER> m_v_shader, m_f_shader;
+	GPUResource<SAMPLER> m_sampler;
+	GPUResource<TEXTURE> m_white;
 	const SDL_GPUColorTargetDescription color_target { .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM };
-	const SDL_GPUVertexBufferDescription buffer_desc[2] { {
+	// pitches & formats of slot 0 & 1 come from the layout
+	SDL_GPUVertexBufferDescription buffer_desc[4] { {
 		.slot = 0,
 		.pitch = sizeof(glm::vec3),
 		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
@@ -83,8 +142,19 @@ private:
 		.pitch = sizeof(glm::vec3),
 		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
 		.instance_step_rate = 0,
+	}, {
+		// the draw's first_instance selects the mesh's GPUInstance
+		.slot = 2,
+		.pitch = sizeof(Uint32),
+		.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
+		.instance_step_rate = 0,
+	}, {
+		.slot = 3,
+		.pitch = sizeof(glm::vec2),
+		.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+		.instance_step_rate = 0,
 	} };
-	const SDL_GPUVertexAttribute vert_attribs[2] { {
+	SDL_GPUVertexAttribute vert_attribs[4] { {
 		.location = 0,
 		.buffer_slot = 0,
 		.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
@@ -94,13 +164,80 @@ private:
 		.buffer_slot = 1,
 		.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
 		.offset = 0,
+	}, {
+		.location = 2,
+		.buffer_slot = 2,
+		.format = SDL_GPU_VERTEXELEMENTFORMAT_UINT,
+		.offset = 0,
+	}, {
+		.location = 3,
+		.buffer_slot = 3,
+		.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2,
+		.offset = 0,
 	} };
 	struct VertexUniforms {
-		glm::mat4 proj_view, model;
+		glm::mat4 proj_view;
+		float position_scale;
 	};
+	// laid out like the cbuffer in BaseColorDepth.frag.hlsl, members don't cross 16 byte boundaries
 	struct FragmentUniforms {
-		glm::vec2 near_far;
+		glm::vec4 base_color;
 		glm::vec3 view_pos;
+		float min_lod; // finest mip level of the texture on the gpu
+		glm::vec2 near_far;
+		Uint32 has_texture;
+		float pad;
+	};
+};
+
+class CullPipeline {
+public:
+	CullPipeline() { }
+	~CullPipeline() { }
+	/**
+	 * Initialize pipeline
+	 *
+	 * @param gpu A valid GPUDevice handle
+	 */
+	SDL_AppResult init(SDL_GPUDevice *gpu);
+	void quit();
+	/**
+	 * Frustum & backface cull every meshlet on the gpu & write one indirect draw command per draw,
+	 * one dispatch per geometry pool, triangle counts are downloaded to the slot's readback buffer
+	 *
+	 * @param cmdbuf The command buffer associated with this compute pass
+	 * @param camera The perspective to cull against
+	 * @param scene The draws & instances to test, commands are written to each pool
+	 * @param slot Readback slot of the frame, reused once the frame's fence is signaled
+	 */
+	void dispatch(SDL_GPUCommandBuffer *cmdbuf, const Camera &camera, const Scene &scene, const Uint32 &slot);
+	// triangles of the frame that culled into a readback slot, see Stats in Cull.comp.hlsl
+	struct CullStats {
+		Uint32 submitted, frustum_culled, backface_culled;
+	};
+	/**
+	 * Read the triangle counts of the last dispatch into slot
+	 *
+	 * @param slot Readback slot, its frame's fence must be signaled
+	 * @return The counts, std::nullopt if nothing was culled into the slot since it was last read
+	 */
+	std::optional<CullStats> stats(const Uint32 &slot);
+	// one per frame in flight, see App::m_fences
+	static constexpr Uint32 readback_slots { FramePacer::max_frames_in_flight };
+private:
+	SDL_GPUDevice *m_gpu;
+	GPUResource<COMPUTE_PIPELINE> m_pipeline;
+	// counters written by every dispatch of a frame, zeroed from m_zero before the first
+	GPUResource<BUFFER> m_stats;
+	GPUResource<TRANSFER_BUFFER> m_zero;
+	GPUResource<TRANSFER_BUFFER> m_readback[readback_slots];
+	bool m_pending[readback_slots] { };
+	// must match numthreads in Cull.comp.hlsl
+	static constexpr Uint32 workgroup_size { 64 };
+	struct ComputeUniforms {
+		std::array<glm::vec4, 6> planes;
+		glm::vec3 camera_pos;
+		Uint32 draw_count;
 	};
 };
 
@@ -112,22 +249,28 @@ public:
 	 * Initialize pipeline
 	 *
 	 * @param gpu A valid GPUDevice handle
+	 * @param format Format of the textures rendered to, the swapchain's or an offscreen composite's
 	 */
-	SDL_AppResult init(SDL_Window *window, SDL_GPUDevice *gpu);
+	SDL_AppResult init(SDL_GPUDevice *gpu, const SDL_GPUTextureFormat &format);
 	void quit();
 	/**
-	 * Render 3D geometry with outline to texture
+	 * Render 3D geometry with outline to texture, upscaling the rendered area to fill dest
 	 *
 	 * @param cmdbuf The command buffer associated with this render pass
 	 * @param dest The destination texture to render to
 	 * @param color Color texture for render input
 	 * @param depth Depth texture for render input
+	 * @param uv_scale The fraction of color & depth that was rendered to
 	 */
-	void render(SDL_GPUCommandBuffer* cmdbuf, SDL_GPUTexture *dest, GPUResource<TEXTURE> &color, GPUResource<TEXTURE> &depth);
+	void render(SDL_GPUCommandBuffer* cmdbuf, SDL_GPUTexture *dest, GPUResource<TEXTURE> &color, GPUResource<TEXTURE> &depth, const glm::vec2 &uv_scale);
 private:
 	GPUResource<GRAPHICS_PIPELINE> m_pipeline;
 	GPUResource<SHADER> m_v_shader, m_f_shader;
-	GPUResource<SAMPLER> m_sampler;
+	// color is filtered when upscaled, depth edges stay sharp
+	GPUResource<SAMPLER> m_sampler, m_linear_sampler;
 	SDL_GPUColorTargetDescription m_color_target;
+	struct FragmentUniforms {
+		glm::vec2 uv_scale;
+	};
 };
 
@@ -0,0 +1,76 @@
+#pragma once
+#include <SDL3/SDL_stdinc.h>
+
+#include <ctime>
+
+// Adjusts the render scale to hold a target frame time
+// frame time alone can't tell a gpu bound frame from one waiting on vsync,
+// so the time spent waiting on the gpu's fence decides which way to go:
+// slow frames with the cpu blocked on the gpu scale down,
+// frames where the gpu was already idle scale back up.
+class ResolutionGovernor {
+public:
+	/**
+	 * Feed the timings of the last frame & update the scale
+	 *
+	 * @param frame_ms Time between the starts of the last two frames
+	 * @param gpu_wait_ms Time the cpu blocked waiting for an earlier frame's fence
+	 */
+	void update(const float &frame_ms, const float &gpu_wait_ms);
+	float scale() const { return m_enabled ? m_scale : max_scale; }
+	bool enabled() const { return m_enabled; }
+	void setEnabled(const bool &enabled);
+	float target_ms { 1000.0f / 60.0f };
+	float min_scale { 0.5f }, max_scale { 1.0f };
+private:
+	bool m_enabled { true };
+	float m_scale { 1.0f };
+	// smoothed timings, a single slow frame shouldn't drop the resolution
+	float m_frame_ms { 0 }, m_gpu_wait_ms { 0 };
+	// frames to hold the scale after a change, the timings need time to settle
+	Uint32 m_cooldown { 0 };
+};
+
+// Per frame timings, averaged & logged once per second
+// along with the share of wall time the process spent on the cpu
+class FrameStats {
+public:
+	/**
+	 * Record one frame
+	 *
+	 * @param frame_ms Time between the starts of the last two frames
+	 * @param gpu_wait_ms Time the cpu blocked waiting for an earlier frame's fence
+	 * @param scale Render scale the frame was drawn at
+	 * @param width Width of the scaled render area
+	 * @param height Height of the scaled render area
+	 */
+	void frame(const float &frame_ms, const float &gpu_wait_ms, const float &scale, const Uint32 &width, const Uint32 &height);
+	// record the time from an input event to the submission of the frame that responds to it
+	void latency(const float &latency_ms);
+	// record that the current frame only redid the composite, nothing in view changed
+	void elided() { ++m_elided; }
+	// record the heap allocations made during the current frame, steady state frames should make none
+	void allocations(const Uint64 &count);
+	/**
+	 * Record the triangles a frame culled on the gpu, read back a few frames after it was drawn
+	 *
+	 * @param submitted Triangles drawn
+	 * @param frustum_culled Triangles of meshlets outside the frustum
+	 * @param backface_culled Triangles of meshlets in the frustum facing away from the camera
+	 */
+	void triangles(const Uint64 &submitted, const Uint64 &frustum_culled, const Uint64 &backface_culled);
+	// record the frames FrameCapture wrote & dropped since the last frame
+	void captures(const Uint32 &written, const Uint32 &dropped);
+private:
+	Uint64 m_period_start { 0 };
+	std::clock_t m_period_cpu { 0 };
+	Uint32 m_frames { 0 }, m_elided { 0 };
+	float m_frame_ms { 0 }, m_max_frame_ms { 0 }, m_gpu_wait_ms { 0 };
+	Uint32 m_inputs { 0 };
+	float m_latency_ms { 0 }, m_max_latency_ms { 0 };
+	Uint32 m_allocating_frames { 0 };
+	Uint64 m_allocations { 0 }, m_max_allocations { 0 };
+	Uint32 m_culled_frames { 0 };
+	Uint64 m_submitted { 0 }, m_frustum_culled { 0 }, m_backface_culled { 0 };
+	Uint32 m_captured { 0 }, m_capture_dropped { 0 };
+};
@@ -0,0 +1,331 @@
+#pragma once
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <SDL3/SDL_gpu.h>
+
+#include <glm/mat4x4.hpp>
+
+#include "BVH.hpp"
+#include "GPUResources.hpp"
+#include "Jobs.hpp"
+#include "Memory.hpp"
+#include "Pipelines.hpp"
+
+namespace fastgltf { class Parser; }
+
+struct GPUBufferAllocationInfo {
+	Uint32 bytes { }, count { };
+	GPUBufferAllocationInfo& operator += (const GPUBufferAllocationInfo &other) {
+		bytes += other.bytes;
+		count += other.count;
+		return *this;
+	}
+};
+struct GeometryAllocationInfo {
+	GPUBufferAllocationInfo indices, verts, norms;
+	GeometryAllocationInfo& operator += (const GeometryAllocationInfo &other) {
+		indices += other.indices;
+		verts += other.verts;
+		norms += other.norms;
+		return *this;
+	}
+};
+
+// First-fit allocator over a range of elements
+// freed ranges merge with their neighbours,
+// when nothing fits the capacity grows to at least twice its size
+class RangeAllocator {
+public:
+	// returns the first element of count consecutive elements
+	Uint32 allocate(const Uint32 &count);
+	void free(const Uint32 &first, const Uint32 &count);
+	// number of elements the backing buffer must hold
+	Uint32 capacity() const { return m_capacity; }
+	// one past the last element in use
+	Uint32 end() const;
+private:
+	std::map<Uint32, Uint32> m_free; // first element -> count
+	Uint32 m_capacity { 0 };
+};
+
+struct Material {
+	glm::vec4 base_color { 1 };
+	Uint32 texture { no_texture }; // id of a StreamedTexture
+	static constexpr Uint32 no_texture { ~0u };
+	bool operator==(const Material &other) const = default;
+};
+
+// consecutive commands of a pool that share a material, drawn by one indirect draw
+struct PoolMaterialRange {
+	Material material;
+	Uint32 first_command, num_commands;
+};
+
+// draw slots of an asset that share a material, spliced into or out of a pool's order by Scene::sortDraws
+struct OrderSplice {
+	Material material;
+	Uint32 first_draw, num_draws;
+	bool removed;
+};
+
+// geometry buffers shared by every asset with the same vertex layout
+struct GeometryPool {
+	VertexLayout layout;
+	GPUGrowableBuffer indices, verts, norms;
+	// texture coordinates are always float2, they share the vertex range
+	GPUGrowableBuffer uvs;
+	// one GPUDraw per meshlet slot, one indirect command per entry of order
+	GPUGrowableBuffer draws, commands;
+	// draw slots of every asset in the pool sorted by material, command i draws order[i]
+	GPUGrowableBuffer order;
+	RangeAllocator index_ranges, vertex_ranges, draw_ranges;
+	// ranges of order sorted by material, every material of the pool is drawn by one indirect draw whatever asset it came from
+	std::vector<PoolMaterialRange> material_ranges;
+	// order as built by Scene::sortDraws, freed draw slots aren't part of it
+	std::vector<Uint32> cpu_order;
+	// index into cpu_order of every draw slot in it, indexed by slot
+	std::vector<Uint32> order_positions;
+	// assets added or removed since the last Scene::sortDraws, in the order it happened
+	std::vector<OrderSplice> splices;
+	// entries of cpu_order changed since the last upload, only these are uploaded unless the order grows
+	std::vector<Uint32> order_changes;
+	// draws as uploaded, indexed by slot, for Scene::cullMeshlets
+	std::vector<GPUDraw> cpu_draws;
+	// one per entry of cpu_order, written by Scene::cullMeshlets & uploaded with the next upload
+	std::vector<SDL_GPUIndexedIndirectDrawCommand> cpu_commands;
+	bool commands_pending { false };
+	// order couldn't be uploaded, it is rebuilt from every asset by the next Scene::sortDraws
+	bool order_dirty { false };
+	// cpu_order changed since it was uploaded
+	bool order_pending { false };
+	// some object of the pool is in view, set by Scene::cull
+	bool visible { true };
+	// number of commands to cull & draw
+	Uint32 drawCount() const { return static_cast<Uint32>(cpu_order.size()); }
+};
+
+using AssetHandle = Uint32;
+
+// a base color texture, transcoded on the background thread & streamed to the gpu coarsest mip first
+struct StreamedTexture {
+	GPUResource<TEXTURE> texture;
+	JobHandle transcode;
+	// written by the transcode job, only read once it is done
+	Uint32 width { 0 }, height { 0 };
+	std::vector<std::vector<Uint8>> levels; // finest first, each one is freed once uploaded
+	bool failed { false };
+	// finest level on the gpu, levels.size() while there is none
+	Uint32 resident_level { 0 };
+	Uint64 bytes { 0 }; // gpu memory of the whole mip chain
+	AssetHandle asset;
+};
+
+// consecutive draw slots of an asset that share a material, merged into the pool's material ranges
+struct MaterialRange {
+	Uint32 material; // index into Asset::materials
+	Uint32 first_draw, num_draws;
+};
+
+// triangles of a mesh kept on the cpu for exact picking, in the mesh's model space
+struct TriangleMesh {
+	std::vector<glm::vec3> positions;
+	std::vector<Uint32> indices; // 3 per triangle
+	BVH bvh; // over triangles
+};
+
+// a glTF file placed in the scene & the ranges it occupies
+struct Asset {
+	glm::mat4 transform;
+	Uint32 pool;
+	Uint32 first_index, num_indices;
+	Uint32 first_vertex, num_vertices;
+	Uint32 first_draw, num_draws;
+	Uint32 first_instance, num_instances;
+	// the file's materials, followed by the default material
+	std::vector<Material> materials;
+	// the asset's draws are ordered by material
+	std::vector<MaterialRange> material_ranges;
+	std::string name;
+	Uint64 load_start { 0 };
+	bool textured { false }; // a texture of the asset has been drawn
+	// one per mesh when the asset was added with Scene::exact_picking, empty otherwise
+	std::vector<TriangleMesh> triangles;
+};
+
+class Scene {
+public:
+	Scene();
+	~Scene();
+	/**
+	 * Initialize scene
+	 *
+	 * @param gpu A valid GPUDevice handle
+	 * @param jobs Job system to decode assets on
+	 */
+	void init(SDL_GPUDevice *gpu, JobSystem *jobs);
+	void quit();
+	/**
+	 * Load a glTF file into the scene, only the new asset's data is uploaded
+	 *
+	 * @param path The file to load
+	 * @param transform Placement of the asset in world space
+	 * @return Handle to the asset, std::nullopt if it could not be loaded
+	 */
+	std::optional<AssetHandle> add(const std::filesystem::path &path, const glm::mat4 &transform);
+	// remove an asset, its ranges are reused by assets added later
+	void remove(const AssetHandle &asset);
+	// move an asset, only its meshes are uploaded again
+	void setTransform(const AssetHandle &asset, const glm::mat4 &transform);
+	/**
+	 * Compute model matrices of meshes added or moved since the last upload & bring the BVH up to date.
+	 * Touches neither pools nor textures, safe to run on a worker alongside sortDraws
+	 */
+	void updateTransforms();
+	/**
+	 * Splice the draws of assets added or removed since the last call into their pool's material order,
+	 * the cost depends on the asset's draws & the pool's materials, not on the rest of the pool.
+	 * Touches neither objects nor the BVH, safe to run on a worker alongside updateTransforms
+	 */
+	void sortDraws();
+	/**
+	 * Upload what updateTransforms, cull & sortDraws prepared & the next mip levels of textures,
+	 * matrices that weren't computed yet are computed here
+	 *
+	 * @param cmdbuf The command buffer of the frame
+	 * @param frame Allocator for lists that only live until the frame is recorded
+	 */
+	void upload(SDL_GPUCommandBuffer *cmdbuf, FrameArena &frame);
+	const std::deque<GeometryPool>& pools() const { return m_pools; }
+	// storage buffer of GPUInstance, one per mesh
+	SDL_GPUBuffer* instances() const { return m_instances.get(); }
+	// vertex buffer of instance indices, one per mesh
+	SDL_GPUBuffer* instanceIds() const { return m_instance_ids.get(); }
+	// meshes of every asset, indexed by instance, meshes of removed assets have no draws
+	const std::vector<Mesh>& objects() const { return m_objects; }
+	const std::unordered_map<AssetHandle, Asset>& assets() const { return m_assets; }
+	// texture with at least one mip level on the gpu, nullptr otherwise
+	const StreamedTexture* texture(const Uint32 &id) const;
+	// bytes of texture memory allocated for every mip level
+	Uint64 textureBytes() const { return m_texture_bytes; }
+	// bytes of the shared geometry, instance & draw buffers
+	Uint64 geometryBytes() const;
+	// bytes of mip levels uploaded per frame at most, a level larger than this is uploaded on its own
+	Uint32 stream_budget_bytes { 4 * 1024 * 1024 };
+	// changes whenever an asset is added, removed or moved
+	Uint64 revision() const { return m_revision; }
+	// insert objects of added assets into the BVH & remove those of removed ones, refit it after assets moved
+	void updateBVH();
+	/**
+	 * Cull objects against a frustum through the BVH, the visible ones are uploaded as a bit mask with the next upload.
+	 * The cull shader skips every meshlet of an object outside the frustum, pools without a visible object aren't dispatched
+	 *
+	 * @param planes Frustum planes from Camera::frustum
+	 * @param frame Allocator for the list of visible objects
+	 */
+	void cull(const std::array<glm::vec4, 6> &planes, FrameArena &frame);
+	// storage buffer of one bit per object, indexed by instance, set for objects in view at the last cull
+	SDL_GPUBuffer* visibility() const { return m_visibility.get(); }
+	/**
+	 * Frustum & backface cull every meshlet of the objects in view on the cpu, as Cull.comp.hlsl does,
+	 * the indirect commands are uploaded with the next upload instead of dispatching CullPipeline.
+	 * Call after cull & sortDraws
+	 *
+	 * @param planes Frustum planes from Camera::frustum
+	 * @param camera_pos Position of the camera in world space
+	 * @return Triangles submitted & culled
+	 */
+	CullPipeline::CullStats cullMeshlets(const std::array<glm::vec4, 6> &planes, const glm::vec3 &camera_pos);
+	struct Pick {
+		Uint32 object; // index into objects()
+		float distance;
+	};
+	/**
+	 * Find the object hit first by a ray, against its triangles if it kept them
+	 *
+	 * @param origin Start of the ray in world space
+	 * @param direction Normalized direction of the ray in world space
+	 * @return The hit object, std::nullopt if nothing was hit
+	 */
+	std::optional<Pick> pick(const glm::vec3 &origin, const glm::vec3 &direction);
+	// BVH over the world space bounds of objects, indexed like objects()
+	const BVH& bvh() const { return m_bvh; }
+	// keep the triangles of assets added from now on, for picks against triangles instead of bounds
+	bool exact_picking { false };
+	// primitives are split into meshlets of at most this many vertices & triangles, each one is a draw
+	static constexpr Uint32 meshlet_vertices { 64 }, meshlet_triangles { 124 };
+	// how much meshlets favour triangles facing the same way over compact bounds, tighter cones cull more
+	static constexpr float meshlet_cone_weight { 0.25f };
+private:
+	// index of the pool for layout, created if there is none
+	Uint32 poolFor(const VertexLayout &layout);
+	void uploadInstances(SDL_GPUCopyPass *copypass);
+	// upload the bit mask of the last cull if it changed
+	void uploadVisibility(SDL_GPUCopyPass *copypass);
+	// order every draw slot of the pool's assets by material from scratch
+	void rebuildOrder(const Uint32 &pool_index);
+	// upload the entries of the material order sortDraws changed
+	void uploadOrders(SDL_GPUCopyPass *copypass);
+	// upload the commands of pools cullMeshlets wrote
+	void uploadCommands(SDL_GPUCopyPass *copypass);
+	// true when a transcoded texture has mip levels left to upload
+	bool texturesPending() const;
+	// upload the next mip levels of transcoded textures, within stream_budget_bytes
+	void streamTextures(SDL_GPUCopyPass *copypass, FrameArena &frame);
+	// world space box of an object, empty without draws
+	AABB worldBounds(const Uint32 &object) const;
+	// wait for the texture's transcode & release it
+	void releaseTexture(const Uint32 &id);
+	SDL_GPUDevice *m_gpu;
+	JobSystem *m_jobs;
+	// kept across loads so its json buffers are reused
+	std::unique_ptr<fastgltf::Parser> m_parser;
+	// scratch of the asset being added, released once it is uploaded
+	std::pmr::monotonic_buffer_resource m_load_arena { 1024 * 1024 };
+	// deque, pools can't be moved
+	std::deque<GeometryPool> m_pools;
+	GPUGrowableBuffer m_instances, m_instance_ids;
+	RangeAllocator m_instance_ranges;
+	GPUResource<TRANSFER_BUFFER> m_instance_transfer_buf;
+	std::vector<Mesh> m_objects;
+	std::unordered_map<AssetHandle, Asset> m_assets;
+	AssetHandle m_next_asset { 0 };
+	Uint64 m_revision { 0 };
+	// unique_ptr, transcode jobs hold on to the texture while the map changes
+	std::unordered_map<Uint32, std::unique_ptr<StreamedTexture>> m_textures;
+	Uint32 m_next_texture { 0 };
+	// block compressed format the backend supports, with the matching basis transcoder format
+	SDL_GPUTextureFormat m_texture_format { SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM };
+	Uint32 m_transcode_format { 0 };
+	GPUResource<TRANSFER_BUFFER> m_texture_transfer_buf;
+	Uint64 m_texture_bytes { 0 };
+	BVH m_bvh;
+	std::vector<AABB> m_world_bounds; // of every object, empty for objects without draws
+	// instance range of an asset added, removed or moved since the BVH was last updated
+	struct BVHChange {
+		enum class Kind { added, removed, moved } kind;
+		Uint32 first, count;
+	};
+	std::vector<BVHChange> m_bvh_changes; // in the order they happened
+	// objects inserted into or removed from the BVH since it was last built
+	Uint32 m_bvh_updates { 0 };
+	// instance ranges to upload, (first, count)
+	std::vector<std::pair<Uint32, Uint32>> m_dirty_instances;
+	// model matrix of every object, m_dirty_instances are computed by updateTransforms
+	std::vector<GPUInstance> m_models;
+	bool m_instances_computed { false };
+	GPUResource<TRANSFER_BUFFER> m_command_transfer_buf;
+	// bit i of word i / 32 is set while object i is in view
+	std::vector<Uint32> m_visibility_bits;
+	bool m_visibility_dirty { false };
+	GPUGrowableBuffer m_visibility;
+	GPUResource<TRANSFER_BUFFER> m_visibility_transfer_buf;
+};
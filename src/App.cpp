@@ -24,97 +24,171 @@ void SDLCALL fileDialogue(void* userdata, const char* const* filelist, int filte
 		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "file is not a GLTF file");
 		return;
 	}
-	ctx->loadGLTF(path);
+	ctx->queueGLTF(path);
 }
 
-SDL_AppResult App::init() {
-	m_window = SDL_CreateWindow("sdl_gltf", m_width, m_height, m_window_flags);
-	if (!m_window) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateWindow failed:\n\t%s", SDL_GetError());
-		return SDL_APP_FAILURE;
+SDL_AppResult App::init(const AppOptions &options) {
+	m_jobs.init();
+	if (!options.headless) {
+		m_window = SDL_CreateWindow("sdl_gltf", m_width, m_height, m_window_flags);
+		if (!m_window) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateWindow failed:\n\t%s", SDL_GetError());
+			return SDL_APP_FAILURE;
+		}
 	}
-	m_gpu = SDL_CreateGPUDevice(m_supported_formats, true, NULL);
+	// validation would dominate the timings of headless benchmarks
+	m_gpu = SDL_CreateGPUDevice(m_supported_formats, !options.headless, NULL);
 	if (!m_gpu) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_CreateGPUDevice failed:\n\t%s", SDL_GetError());
 		return SDL_APP_FAILURE;
 	}
-	if (!SDL_ClaimWindowForGPUDevice(m_gpu, m_window)) {
+	if (m_window && !SDL_ClaimWindowForGPUDevice(m_gpu, m_window)) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_ClaimWindowForGPUDevice failed:\n\t%s", SDL_GetError());
 		return SDL_APP_FAILURE;
 	}
-	if (!SDL_SetWindowRelativeMouseMode(m_window, true)) {
+	if (!m_pacer.init(m_gpu, m_window)) {
+		return SDL_APP_FAILURE;
+	}
+	if (m_window && !SDL_SetWindowRelativeMouseMode(m_window, true)) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"SDL_SetWindowRelativeMouseMode failed:\n\t%s", SDL_GetError());
 		return SDL_APP_FAILURE;
 	}
 
 	// init pipelines
+	m_composite.info = {
+		.type = SDL_GPU_TEXTURETYPE_2D,
+		.format = m_window ? SDL_GetGPUSwapchainTextureFormat(m_gpu, m_window) : SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM,
+		.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+		.sample_count = SDL_GPU_SAMPLECOUNT_1,
+	};
 	if (m_blinnphong_pipeline.init(m_gpu) != 0)
 		return SDL_APP_FAILURE;
-	if (m_outline_pipeline.init(m_window, m_gpu) != 0)
+	if (m_outline_pipeline.init(m_gpu, m_composite.info.format) != 0)
+		return SDL_APP_FAILURE;
+	if (m_cull_pipeline.init(m_gpu) != 0)
 		return SDL_APP_FAILURE;
+	m_scene.init(m_gpu, &m_jobs);
+	m_capture.init(m_gpu, &m_jobs);
+	if (!options.capture_directory.empty() && !m_capture.start(options.capture_directory, CaptureSource::composite)) {
+		return SDL_APP_FAILURE;
+	}
+
+	// hold the display's refresh interval
+	if (m_window) {
+		if (const SDL_DisplayMode *mode { SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(m_window)) }; mode && mode->refresh_rate > 0) {
+			m_governor.target_ms = 1000.0f / mode->refresh_rate;
+		}
+	}
 
 	// create textures
 	m_depth.info = {
 		.type = SDL_GPU_TEXTURETYPE_2D,
 		.format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
 		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET,
-		.width = m_width,
-		.height = m_height,
 		.layer_count_or_depth = 1,
 		.num_levels = 1,
 		.sample_count = SDL_GPU_SAMPLECOUNT_1,
 	};
-	if (!m_depth.create(m_gpu)) { return SDL_APP_FAILURE; }
 	m_color.info = {
 		.type = SDL_GPU_TEXTURETYPE_2D,
 		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
 		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COLOR_TARGET,
-		.width = m_width,
-		.height = m_height,
 		.layer_count_or_depth = 1,
 		.num_levels = 1,
 		.sample_count = SDL_GPU_SAMPLECOUNT_1,
 	};
-	if (!m_color.create(m_gpu)) { return SDL_APP_FAILURE; }
+	if (!createTargets()) { return SDL_APP_FAILURE; }
 
-	loadGLTF(SDL_GetBasePath() + std::string("meshes/cubes.glb"));
+	if (m_window) {
+		if (const std::optional<AssetHandle> asset { m_scene.add(SDL_GetBasePath() + std::string("meshes/cubes.glb"), glm::mat4(1)) }; asset) {
+			m_assets.push_back(asset.value());
+		}
+	}
 	return SDL_APP_CONTINUE;
 }
 
 void App::quit() {
 	m_blinnphong_pipeline.quit();
 	m_outline_pipeline.quit();
+	m_cull_pipeline.quit();
+	// texture transcodes & frame encodes may still be running on the job system
+	m_capture.quit();
+	m_scene.quit();
+	m_jobs.quit();
+	for (SDL_GPUFence *fence : m_fences) {
+		if (fence) { SDL_ReleaseGPUFence(m_gpu, fence); }
+	}
 	m_color.release();
 	m_depth.release();
-	m_i_buf.release();
-	m_v_buf.release();
-	m_norm_buf.release();
+	if (m_composite.get()) { m_composite.release(); }
+	// everything created should have been released by now
+	GPUResourceRegistry::log();
+	GPUResourceRegistry::reportLeaks();
 	SDL_DestroyGPUDevice(m_gpu);
-	SDL_DestroyWindow(m_window);
+	if (m_window) { SDL_DestroyWindow(m_window); }
 }
 
 SDL_AppResult App::event(SDL_Event *e) {
 	m_camera.event(e);
 	switch(e->type) {
+	case SDL_EVENT_MOUSE_BUTTON_DOWN:
+		m_pacer.input(e->common.timestamp);
+		// the cursor is hidden in relative mode, pick what is in the center of the view
+		if (e->button.button == SDL_BUTTON_LEFT) {
+			pick();
+		}
+		break;
+	case SDL_EVENT_MOUSE_MOTION:
+	case SDL_EVENT_KEY_UP:
+		m_pacer.input(e->common.timestamp);
+		break;
 	case SDL_EVENT_WINDOW_RESIZED: {
 		m_width = e->window.data1;
 		m_height = e->window.data2;
-		// resize textures
-		m_depth.release();
-		m_depth.info.width = m_width;
-		m_depth.info.height = m_height;
-		m_depth.create(m_gpu);
-		m_color.release();
-		m_color.info.width = m_width;
-		m_color.info.height = m_height;
-		m_color.create(m_gpu);
+		createTargets();
 		break;
 	}
 	case SDL_EVENT_KEY_DOWN:
+		m_pacer.input(e->common.timestamp);
 		switch(e->key.key) {
 		case SDLK_R:
 			openGLTF();
 			break;
+		case SDLK_F2:
+			m_governor.setEnabled(!m_governor.enabled());
+			break;
+		case SDLK_F3:
+			m_pacer.cyclePresentMode();
+			break;
+		case SDLK_F4:
+			m_pacer.cycleFramesInFlight();
+			break;
+		case SDLK_F5:
+			m_pacer.cycleFrameCap();
+			break;
+		case SDLK_F7:
+		case SDLK_F8:
+			// F7 captures what the window shows, F8 the color target at render scale
+			if (m_capture.active()) {
+				m_capture.stop();
+			} else {
+				m_capture.start(SDL_GetBasePath() + std::string("captures"), e->key.key == SDLK_F7 ? CaptureSource::composite : CaptureSource::color);
+			}
+			break;
+		case SDLK_F9:
+			GPUResourceRegistry::log();
+			break;
+		case SDLK_F6:
+			m_scene.exact_picking = !m_scene.exact_picking;
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Assets added from now on are picked against %s",
+					m_scene.exact_picking ? "triangles" : "bounds");
+			break;
+		case SDLK_BACKSPACE:
+		case SDLK_DELETE:
+			removeGLTF();
+			break;
 		}
 		break;
 	}
@@ -122,35 +196,197 @@ SDL_AppResult App::event(SDL_Event *e) {
 }
 
 SDL_AppResult App::iterate() {
-	// update camera data & sort objects by distance from camera
-	m_camera.iterate();
-	std::sort(m_objects.begin(), m_objects.end(), [&](const Mesh &a, const Mesh &b) -> bool {
-		const float dist_a { glm::distance(m_camera.pos, a.pos) };
-		const float dist_b { glm::distance(m_camera.pos, b.pos) };
-		return dist_a ? dist_a > dist_b : dist_b;
-	});
+	// capped frame rates sleep here instead of queueing frames
+	m_pacer.limit();
+	const Uint64 allocations_start { heapAllocations() };
+	m_frame_arena.reset();
+	// wait for the frames that must be done before this one, the time blocked tells the governor if the gpu is the bottleneck
+	const Uint64 frame_start { SDL_GetTicksNS() };
+	const float frame_ms { m_last_frame_start ? (frame_start - m_last_frame_start) / 1e6f : 0.0f };
+	m_last_frame_start = frame_start;
+	const Uint32 slot { static_cast<Uint32>(m_frame_index % FramePacer::max_frames_in_flight) };
+	// every frame at least framesInFlight back, more than one right after the count was lowered
+	for (Uint32 back = FramePacer::max_frames_in_flight; back >= m_pacer.framesInFlight(); --back) {
+		SDL_GPUFence *&fence { m_fences[(m_frame_index + FramePacer::max_frames_in_flight - back) % FramePacer::max_frames_in_flight] };
+		if (!fence) { continue; }
+		SDL_WaitForGPUFences(m_gpu, true, &fence, 1);
+		SDL_ReleaseGPUFence(m_gpu, fence);
+		fence = nullptr;
+	}
+	const float gpu_wait_ms { (SDL_GetTicksNS() - frame_start) / 1e6f };
+	// hand finished captures to encoders without waiting on the ones still downloading
+	const Uint32 captured { m_capture.poll() };
+	m_stats.captures(captured, m_capture.dropped());
+	// triangle counts of the frame that last used this slot are downloaded by now
+	if (const std::optional<CullPipeline::CullStats> cull_stats { m_cull_pipeline.stats(slot) }; cull_stats) {
+		m_stats.triangles(cull_stats->submitted, cull_stats->frustum_culled, cull_stats->backface_culled);
+	}
+	// frames after an idle one include the sleep, they say nothing about the gpu
+	if (frame_ms && !m_idle) { m_governor.update(frame_ms, gpu_wait_ms); }
+
+	// block until the swapchain can take a frame, rather than after recording,
+	// then sample mouse motion queued in the meantime so the view is as fresh as possible
+	if (m_window) {
+		if (!SDL_WaitForGPUSwapchain(m_gpu, m_window)) {
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SDL_WaitForGPUSwapchain failed\n\t%s", SDL_GetError());
+			return SDL_APP_FAILURE;
+		}
+		SDL_PumpEvents();
+		SDL_Event late_events[64];
+		int num_late_events;
+		while ((num_late_events = SDL_PeepEvents(late_events, SDL_arraysize(late_events), SDL_GETEVENT, SDL_EVENT_MOUSE_MOTION, SDL_EVENT_MOUSE_MOTION)) > 0) {
+			for (int i = 0; i < num_late_events; ++i) {
+				event(&late_events[i]);
+			}
+		}
+	}
+
+	// add files picked since the last frame, only their data is uploaded
+	std::vector<std::filesystem::path> pending_loads;
+	{
+		std::lock_guard lock { m_pending_mutex };
+		pending_loads.swap(m_pending_loads);
+	}
+	for (const std::filesystem::path &path : pending_loads) {
+		loadGLTF(path);
+	}
+
+	// frame graph, every stage touches its own part of the app & scene:
+	//   camera ─────┐
+	//   transforms ─┼─ cull ─ record
+	//   sort ───────┘
+	// input was handled above & record runs below on the main thread, SDL wants events & the swapchain there.
+	// Meshlets of the objects cull finds in view are culled on the gpu, or by cull itself without gpu culling,
+	// sort only has work after assets changed
+	const float scale { m_governor.scale() };
+	const Uint32 render_width { SDL_clamp(static_cast<Uint32>(m_width * scale + 0.5f), 1u, m_color.info.width) };
+	const Uint32 render_height { SDL_clamp(static_cast<Uint32>(m_height * scale + 0.5f), 1u, m_color.info.height) };
+	const Uint32 ticks { m_pacer.advance() };
+	const float alpha { m_pacer.alpha() };
+	const JobHandle camera_job { m_jobs.submit([this, ticks, alpha] {
+		for (Uint32 i = 0; i < ticks; ++i) {
+			m_camera.iterate();
+		}
+		m_camera.interpolate(alpha);
+	}) };
+	// model matrices of meshes added or moved & the BVH over them
+	const JobHandle transforms_job { m_jobs.submit([this] { m_scene.updateTransforms(); }) };
+	// material order of pools whose assets changed
+	const JobHandle sort_job { m_jobs.submit([this] { m_scene.sortDraws(); }) };
+	glm::mat4 proj_view;
+	const JobHandle cull_deps[3] { camera_job, transforms_job, sort_job };
+	const JobHandle cull_job { m_jobs.submit([this, &proj_view, render_width, render_height] {
+		// color & depth still hold this exact view when nothing changed, only the composite is redone
+		proj_view = m_camera.proj() * m_camera.view();
+		m_idle = m_elide_idle && !m_targets_dirty &&
+			proj_view == m_rendered.proj_view &&
+			m_scene.revision() == m_rendered.scene_revision &&
+			render_width == m_rendered.width && render_height == m_rendered.height;
+		if (m_idle) { return; }
+		// objects in view through the BVH, uploaded with the frame's matrices & textures
+		const std::array<glm::vec4, 6> planes { m_camera.frustum() };
+		m_scene.cull(planes, m_frame_arena);
+		if (!m_gpu_culling) { m_cpu_cull_stats = m_scene.cullMeshlets(planes, m_camera.pos); }
+	}, cull_deps) };
 
 	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(m_gpu) };
+	m_jobs.wait(cull_job);
 	if (!cmdbuf) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_AcquireGPUCommandBuffer failed\n\t%s", SDL_GetError());
 		return SDL_APP_FAILURE;
 	}
+	m_scene.upload(cmdbuf, m_frame_arena);
+	if (!m_idle) {
+		// cull meshlets of objects in view on the gpu & write indirect draw commands
+		if (m_gpu_culling) {
+			m_cull_pipeline.dispatch(cmdbuf, m_camera, m_scene, slot);
+		} else {
+			m_stats.triangles(m_cpu_cull_stats.submitted, m_cpu_cull_stats.frustum_culled, m_cpu_cull_stats.backface_culled);
+		}
 
-	// render geometry to color & depth textures
-	m_blinnphong_pipeline.render(cmdbuf, m_color, m_depth, m_camera, m_objects, m_i_buf, m_v_buf, m_norm_buf);
+		// render geometry to the scaled area of color & depth textures
+		const SDL_GPUViewport viewport { 0, 0, static_cast<float>(render_width), static_cast<float>(render_height), 0, 1 };
+		m_blinnphong_pipeline.render(cmdbuf, m_color, m_depth, viewport, m_camera, m_scene);
+		m_rendered = { proj_view, m_scene.revision(), render_width, render_height };
+		m_targets_dirty = false;
+	} else {
+		m_stats.elided();
+	}
 
-	// render color & depth textures to window
-	SDL_GPUTexture *swapchain;
-	if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, m_window, &swapchain, &m_width, &m_height)) {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SDL_WaitAndAcquireGPUSwapchainTexture failed\n\t%s", SDL_GetError());
+	// render color & depth textures to window, the swapchain was waited on already
+	SDL_GPUTexture *swapchain { m_composite.get() };
+	if (m_window && !SDL_AcquireGPUSwapchainTexture(cmdbuf, m_window, &swapchain, &m_width, &m_height)) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "SDL_AcquireGPUSwapchainTexture failed\n\t%s", SDL_GetError());
+		SDL_CancelGPUCommandBuffer(cmdbuf);
 		return SDL_APP_FAILURE;
 	}
-	if (!swapchain) { return SDL_APP_FAILURE; }
-	m_outline_pipeline.render(cmdbuf, swapchain, m_color, m_depth);
-	SDL_SubmitGPUCommandBuffer(cmdbuf);
+	const glm::vec2 uv_scale {
+		static_cast<float>(render_width) / m_color.info.width,
+		static_cast<float>(render_height) / m_color.info.height
+	};
+	// a captured composite is rendered offscreen & blitted to the window
+	const SDL_GPUTextureFormat swapchain_format { m_composite.info.format };
+	SDL_GPUTexture *capture_target { nullptr };
+	if (m_capture.active() && m_capture.source() == CaptureSource::composite && m_width && m_height) {
+		capture_target = m_capture.target(m_width, m_height, swapchain_format);
+	}
+	if (capture_target) {
+		m_outline_pipeline.render(cmdbuf, capture_target, m_color, m_depth, uv_scale);
+		if (swapchain) {
+			const SDL_GPUBlitInfo blit {
+				.source = { .texture = capture_target, .w = m_width, .h = m_height },
+				.destination = { .texture = swapchain, .w = m_width, .h = m_height },
+				.load_op = SDL_GPU_LOADOP_DONT_CARE,
+				.filter = SDL_GPU_FILTER_NEAREST,
+			};
+			SDL_BlitGPUTexture(cmdbuf, &blit);
+		}
+	} else if (swapchain) {
+		// no swapchain texture while minimized, the frame's uploads are still submitted
+		m_outline_pipeline.render(cmdbuf, swapchain, m_color, m_depth, uv_scale);
+	}
+	const Uint64 frame_index { m_frame_index };
+	m_fences[slot] = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+	++m_frame_index;
+	// downloads go on their own command buffer after the frame, polled by later frames
+	if (capture_target) {
+		m_capture.capture(capture_target, swapchain_format, m_width, m_height, frame_index);
+	} else if (m_capture.active() && m_capture.source() == CaptureSource::color) {
+		m_capture.capture(m_color.get(), m_color.info.format, render_width, render_height, frame_index);
+	}
+	m_stats.allocations(heapAllocations() - allocations_start);
+	m_stats.frame(frame_ms, gpu_wait_ms, scale, render_width, render_height);
+	if (const float latency_ms { m_pacer.submitted() }; latency_ms) {
+		m_stats.latency(latency_ms);
+	}
+	// sleep until something happens, the timeout keeps stats & pending loads moving,
+	// captures take every frame
+	if (m_idle && !m_capture.active()) {
+		SDL_WaitEventTimeout(nullptr, idle_timeout_ms);
+	}
 	return SDL_APP_CONTINUE;
 }
 
+bool App::createTargets() {
+	// over-allocate for the largest scale, changing the scale only changes the viewport
+	const Uint32 width { SDL_max(static_cast<Uint32>(m_width * m_governor.max_scale + 0.5f), 1u) };
+	const Uint32 height { SDL_max(static_cast<Uint32>(m_height * m_governor.max_scale + 0.5f), 1u) };
+	m_targets_dirty = true;
+	if (m_depth.get()) { m_depth.release(); }
+	m_depth.info.width = width;
+	m_depth.info.height = height;
+	if (!m_depth.create(m_gpu)) { return false; }
+	if (m_color.get()) { m_color.release(); }
+	m_color.info.width = width;
+	m_color.info.height = height;
+	if (!m_color.create(m_gpu)) { return false; }
+	if (m_window) { return true; }
+	if (m_composite.get()) { m_composite.release(); }
+	m_composite.info.width = m_width;
+	m_composite.info.height = m_height;
+	return m_composite.create(m_gpu);
+}
+
 SDL_AppResult App::openGLTF() {
 	const SDL_DialogFileFilter filter[2] = {
 		{ "GLB", "glb" },
@@ -160,177 +396,38 @@ SDL_AppResult App::openGLTF() {
 	return SDL_APP_CONTINUE;
 }
 
-void App::loadGLTF(const std::filesystem::path& path) {
-	m_objects.clear();
-	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Loading GLTF file: %s", path.c_str());
-	fastgltf::Parser parser;
-	fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(path);
-	if (data.error() != fastgltf::Error::None) {
-		switch(data.error()) {
-		case fastgltf::Error::InvalidPath:
-			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Invalid path, resuming application");
-			break;
-		case fastgltf::Error::InvalidFileData:
-		case fastgltf::Error::InvalidGLB:
-		case fastgltf::Error::InvalidGltf:
-			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Invalid data, resuming application");
-			break;
-		default:
-			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Error occured while parsing file, resuming application");
-			break;
-		}
-		return;
+void App::queueGLTF(const std::filesystem::path &path) {
+	{
+		std::lock_guard lock { m_pending_mutex };
+		m_pending_loads.push_back(path);
 	}
-	auto asset { parser.loadGltf(
-			data.get(),
-			path.parent_path(),
-			fastgltf::Options::DecomposeNodeMatrices |
-			fastgltf::Options::LoadExternalBuffers |
-			fastgltf::Options::GenerateMeshIndices
-	) };
-	if (asset.error() != fastgltf::Error::None) {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Error occured while loading gltf, resuming application");
+	// wake the main loop if it is idle
+	SDL_Event wake { .type = SDL_EVENT_USER };
+	SDL_PushEvent(&wake);
+}
+
+void App::pick() {
+	const std::optional<Scene::Pick> hit { m_scene.pick(m_camera.pos, m_camera.ray({ 0, 0 })) };
+	if (!hit) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Picked nothing");
 		return;
 	}
+	const Mesh &mesh { m_scene.objects()[hit->object] };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Picked mesh %u of %s, %.2f units away",
+			hit->object, m_scene.assets().at(mesh.asset).name.c_str(), hit->distance);
+}
 
-	auto sizeOfBuffer = [&](const fastgltf::Accessor &access) -> Uint32 {
-		SDL_assert(access.bufferViewIndex.has_value());
-		return static_cast<Uint32>(asset->bufferViews.at(access.bufferViewIndex.value()).byteLength);
-	};
-
-	auto processPrimitive = [&](const fastgltf::Primitive &prim) -> GeometryAllocationInfo {
-		switch(prim.type) {
-			case fastgltf::PrimitiveType::Triangles:
-				break;
-			default:
-				SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Primitive types other than triangle lists are not supported");
-				break;
-		}
-		const fastgltf::Attribute *pos { prim.findAttribute("POSITION") };
-		const fastgltf::Attribute *norm { prim.findAttribute("NORMAL") };
-
-		SDL_assert(prim.indicesAccessor.has_value());
-		SDL_assert(pos);
-		SDL_assert(norm);
-		fastgltf::Accessor &index_access { asset->accessors.at(prim.indicesAccessor.value()) };
-		fastgltf::Accessor &vertex_access { asset->accessors.at(pos->accessorIndex) };
-		fastgltf::Accessor &normal_access { asset->accessors.at(norm->accessorIndex) };
-		const GeometryAllocationInfo info {
-			{ sizeOfBuffer(index_access), static_cast<Uint32>(index_access.count), },
-			{ sizeOfBuffer(vertex_access), static_cast<Uint32>(vertex_access.count) },
-			{ sizeOfBuffer(normal_access), static_cast<Uint32>(normal_access.count) }
-		};
-		return info;
-	};
-
-	auto processMesh = [processPrimitive](const fastgltf::Mesh &mesh) -> GeometryAllocationInfo {
-		GeometryAllocationInfo info {};
-		for (const fastgltf::Primitive &prim : mesh.primitives) {
-			info += processPrimitive(prim);
-		}
-		return info;
-	};
-	GeometryAllocationInfo scene_buffer_info;
-	// traverse nodes
-	fastgltf::iterateSceneNodes(asset.get(), asset->defaultScene.value(), fastgltf::math::fmat4x4(), 
-								[&](fastgltf::Node &node, fastgltf::math::fmat4x4 TRS) {
-		glm::vec3 pos, scale;
-		glm::quat rot;
-		if (const auto TRS (std::get_if<fastgltf::TRS>(&node.transform)); TRS) {
-			pos = {TRS->translation.x(), TRS->translation.y(), TRS->translation.z()};
-			scale = {TRS->scale.x(), TRS->scale.y(), TRS->scale.z()};
-			rot = {TRS->rotation.w(), TRS->rotation.x(), TRS->rotation.y(), TRS->rotation.z()};
-		} else {
-			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Node transforms must be decomposed");
-			return;
-		}
-		const Uint32 index_start { scene_buffer_info.indices.count };
-		SDL_assert(node.meshIndex.has_value());
-		const fastgltf::Mesh &mesh { asset->meshes.at(node.meshIndex.value()) };
-		const GeometryAllocationInfo mesh_info { processMesh(mesh) };
-		scene_buffer_info += mesh_info;
-		m_objects.emplace_back(pos, scale, rot, mesh_info.indices.count, index_start);
-	});
-	// create buffers
-	m_i_buf.info = { SDL_GPU_BUFFERUSAGE_INDEX, scene_buffer_info.indices.bytes };
-	m_v_buf.info = { SDL_GPU_BUFFERUSAGE_VERTEX, scene_buffer_info.verts.bytes };
-	m_norm_buf.info = { SDL_GPU_BUFFERUSAGE_VERTEX, scene_buffer_info.norms.bytes };
-	// if there already is a buffer, release it
-	if (m_i_buf.get()) { m_i_buf.release(); }
-	if (!m_i_buf.create(m_gpu)) { return; }
-	if (m_v_buf.get()) { m_v_buf.release(); }
-	if (!m_v_buf.create(m_gpu)) { return; }
-	if (m_norm_buf.get()) { m_norm_buf.release(); }
-	if (!m_norm_buf.create(m_gpu)) { return; }
-
-	// returns allocation information for uploaded primitive
-	auto uploadPrimitive = [&](SDL_GPUCopyPass *copypass, const fastgltf::Primitive &prim, const GeometryAllocationInfo &offsets) -> GeometryAllocationInfo {
-		// get index info
-		const fastgltf::Accessor &i_access { 
-			asset->accessors.at( prim.indicesAccessor.value() )
-		};
-		// get vert info
-		const fastgltf::Accessor &v_access {
-			asset->accessors.at( prim.findAttribute("POSITION")->accessorIndex )
-		};
-		// get normals info
-		const fastgltf::Accessor &norm_access {
-			asset->accessors.at( prim.findAttribute("NORMAL")->accessorIndex )
-		};
-
-		const GeometryAllocationInfo prim_info {
-			{ sizeOfBuffer(i_access), static_cast<Uint32>(i_access.count), },
-			{ sizeOfBuffer(v_access), static_cast<Uint32>(v_access.count) },
-			{ sizeOfBuffer(norm_access), static_cast<Uint32>(norm_access.count) }
-		};
-		// create transfer buffer
-		GPUResource<TRANSFER_BUFFER> transfer_buf;
-		transfer_buf.info = {
-			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-			.size = prim_info.indices.bytes + 
-					prim_info.verts.bytes + 
-					prim_info.norms.bytes,
-		};
-		if (!transfer_buf.create(m_gpu)) { return { }; }
-		Uint16 *i_data { static_cast<Uint16*>(SDL_MapGPUTransferBuffer(m_gpu, transfer_buf.get(), false)) };
-		fastgltf::copyFromAccessor<Uint16>(asset.get(), i_access, i_data);
-		glm::vec3 *v_data { reinterpret_cast<glm::vec3*>(i_data + prim_info.indices.count) };
-		fastgltf::copyFromAccessor<glm::vec3>(asset.get(), v_access, v_data);
-		glm::vec3 *norm_data { v_data + v_access.count };
-		fastgltf::copyFromAccessor<glm::vec3>(asset.get(), norm_access, norm_data);
-		// move data to gpu using copy pass
-		SDL_GPUTransferBufferLocation trans_buf_loc {
-			.transfer_buffer = transfer_buf.get(),
-			.offset = 0
-		};
-		const SDL_GPUBufferRegion attribute_regions[3] {
-			{ m_i_buf.get(), offsets.indices.bytes, prim_info.indices.bytes },
-			{ m_v_buf.get(), offsets.verts.bytes, prim_info.verts.bytes },
-			{ m_norm_buf.get(), offsets.norms.bytes, prim_info.norms.bytes }
-		};
-		SDL_UnmapGPUTransferBuffer(m_gpu, transfer_buf.get());
-		SDL_UploadToGPUBuffer(copypass, &trans_buf_loc, &attribute_regions[0], false);
-		trans_buf_loc.offset += prim_info.indices.bytes;
-		SDL_UploadToGPUBuffer(copypass, &trans_buf_loc, &attribute_regions[1], false);
-		trans_buf_loc.offset += prim_info.verts.bytes;
-		SDL_UploadToGPUBuffer(copypass, &trans_buf_loc, &attribute_regions[2], false);
-		transfer_buf.release();
-		return prim_info;
-	};
-
-	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(m_gpu) };
-	GeometryAllocationInfo offsets { };
-	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
-	fastgltf::iterateSceneNodes(asset.get(), asset->defaultScene.value(), fastgltf::math::fmat4x4(), 
-								[&](fastgltf::Node &node, fastgltf::math::fmat4x4 TRS) {
-		const fastgltf::Mesh &mesh { asset->meshes.at(node.meshIndex.value()) };
-		// traverse primitives of this node's mesh
-		for (const fastgltf::Primitive &prim : mesh.primitives) {
-			GeometryAllocationInfo uploaded { uploadPrimitive(copypass, prim, offsets) };
-			offsets += uploaded;
-		}
-	});
-	SDL_EndGPUCopyPass(copypass);
-	SDL_SubmitGPUCommandBuffer(cmdbuf);
+void App::removeGLTF() {
+	if (m_assets.empty()) { return; }
+	m_scene.remove(m_assets.back());
+	m_assets.pop_back();
 }
 
+bool App::loadGLTF(const std::filesystem::path &path) {
+	// place the asset a short distance in front of the camera
+	const glm::mat4 transform { glm::translate(glm::mat4(1), m_camera.pos + m_camera.forward() * 20.0f) };
+	const std::optional<AssetHandle> asset { m_scene.add(path, transform) };
+	if (!asset) { return false; }
+	m_assets.push_back(asset.value());
+	return true;
+}
@@ -0,0 +1,368 @@
+#include "BVH.hpp"
+
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+
+void AABB::grow(const glm::vec3 &point) {
+	min = glm::min(min, point);
+	max = glm::max(max, point);
+}
+
+void AABB::grow(const AABB &other) {
+	min = glm::min(min, other.min);
+	max = glm::max(max, other.max);
+}
+
+float AABB::area() const {
+	if (empty()) { return 0; }
+	const glm::vec3 extent { max - min };
+	return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+AABB AABB::transformed(const glm::mat4 &transform) const {
+	if (empty()) { return *this; }
+	// Arvo: each column's contribution is smallest at one of the two extremes
+	AABB result;
+	result.min = result.max = glm::vec3(transform[3]);
+	for (Uint32 column = 0; column < 3; ++column) {
+		const glm::vec3 a { glm::vec3(transform[column]) * min[column] };
+		const glm::vec3 b { glm::vec3(transform[column]) * max[column] };
+		result.min += glm::min(a, b);
+		result.max += glm::max(a, b);
+	}
+	return result;
+}
+
+void BVH::build(std::span<const AABB> bounds, JobSystem *jobs) {
+	m_indices.clear();
+	m_nodes.clear();
+	m_parents.clear();
+	m_entries.assign(bounds.size(), none);
+	for (Uint32 i = 0; i < bounds.size(); ++i) {
+		if (!bounds[i].empty()) { m_indices.push_back(i); }
+	}
+	m_size = static_cast<Uint32>(m_indices.size());
+	m_bounds.resize(m_indices.size());
+	m_leaves.resize(m_indices.size());
+	if (m_indices.empty()) { return; }
+	// a binary tree with at least one primitive per leaf never needs more nodes than this
+	m_nodes.resize(m_indices.size() * 2 - 1);
+	m_parents.resize(m_nodes.size());
+	m_parents[0] = none;
+	std::atomic<Uint32> node_count { 1 };
+	buildNode(0, 0, static_cast<Uint32>(m_indices.size()), bounds, node_count, jobs);
+	m_nodes.resize(node_count);
+	m_parents.resize(node_count);
+	// partitioning during the build moved primitives between entries
+	for (Uint32 i = 0; i < m_indices.size(); ++i) {
+		m_bounds[i] = bounds[m_indices[i]];
+		m_entries[m_indices[i]] = i;
+	}
+	for (Uint32 node = 0; node < m_nodes.size(); ++node) {
+		for (Uint32 i = m_nodes[node].first; i < m_nodes[node].first + m_nodes[node].count; ++i) {
+			m_leaves[i] = node;
+		}
+	}
+}
+
+void BVH::buildNode(const Uint32 &node, const Uint32 &begin, const Uint32 &end, std::span<const AABB> bounds, std::atomic<Uint32> &node_count, JobSystem *jobs) {
+	AABB node_bounds, centers;
+	for (Uint32 i = begin; i < end; ++i) {
+		node_bounds.grow(bounds[m_indices[i]]);
+		centers.grow(bounds[m_indices[i]].center());
+	}
+	const Uint32 count { end - begin };
+	m_nodes[node] = { node_bounds, begin, count };
+	if (count <= min_leaf) { return; }
+
+	// bin primitives by center along each axis & find the split with the lowest SAH cost
+	const glm::vec3 extent { centers.max - centers.min };
+	auto binOf = [&](const Uint32 &primitive, const Uint32 &axis) -> Uint32 {
+		const float offset { (bounds[primitive].center()[axis] - centers.min[axis]) * (bins / extent[axis]) };
+		return SDL_min(static_cast<Uint32>(offset), bins - 1);
+	};
+	float best_cost { std::numeric_limits<float>::max() };
+	Uint32 best_axis { 0 }, best_split { 0 };
+	for (Uint32 axis = 0; axis < 3; ++axis) {
+		if (extent[axis] <= 0) { continue; }
+		std::array<AABB, bins> bin_bounds;
+		std::array<Uint32, bins> bin_counts { };
+		for (Uint32 i = begin; i < end; ++i) {
+			const Uint32 bin { binOf(m_indices[i], axis) };
+			bin_bounds[bin].grow(bounds[m_indices[i]]);
+			++bin_counts[bin];
+		}
+		// sweep from the right first, so every plane's cost comes from one more sweep from the left
+		std::array<float, bins - 1> right_areas;
+		std::array<Uint32, bins - 1> right_counts;
+		AABB right;
+		Uint32 right_count { 0 };
+		for (Uint32 bin = bins - 1; bin > 0; --bin) {
+			right.grow(bin_bounds[bin]);
+			right_count += bin_counts[bin];
+			right_areas[bin - 1] = right.area();
+			right_counts[bin - 1] = right_count;
+		}
+		AABB left;
+		Uint32 left_count { 0 };
+		for (Uint32 plane = 0; plane < bins - 1; ++plane) {
+			left.grow(bin_bounds[plane]);
+			left_count += bin_counts[plane];
+			if (!left_count || !right_counts[plane]) { continue; }
+			const float cost { left_count * left.area() + right_counts[plane] * right_areas[plane] };
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_axis = axis;
+				best_split = plane;
+			}
+		}
+	}
+
+	// a leaf costs a test per primitive, splitting adds about one more test for the node itself
+	const float leaf_cost { count * node_bounds.area() };
+	const bool found { best_cost < std::numeric_limits<float>::max() };
+	if (count <= max_leaf && (!found || best_cost + node_bounds.area() >= leaf_cost)) { return; }
+	Uint32 mid { begin + count / 2 };
+	if (found) {
+		mid = static_cast<Uint32>(std::partition(m_indices.begin() + begin, m_indices.begin() + end, [&](const Uint32 &primitive) {
+			return binOf(primitive, best_axis) <= best_split;
+		}) - m_indices.begin());
+	}
+	// every center in one place, any split is as good as another
+	if (mid == begin || mid == end) { mid = begin + count / 2; }
+
+	const Uint32 left { node_count.fetch_add(2) };
+	m_nodes[node].first = left;
+	m_nodes[node].count = 0;
+	m_parents[left] = m_parents[left + 1] = node;
+	if (jobs && count > parallel_size) {
+		const JobHandle left_job { jobs->submit([this, left, begin, mid, bounds, &node_count, jobs] {
+			buildNode(left, begin, mid, bounds, node_count, jobs);
+		}) };
+		buildNode(left + 1, mid, end, bounds, node_count, jobs);
+		jobs->wait(left_job);
+	} else {
+		buildNode(left, begin, mid, bounds, node_count, nullptr);
+		buildNode(left + 1, mid, end, bounds, node_count, nullptr);
+	}
+}
+
+void BVH::refit(std::span<const AABB> bounds) {
+	for (Uint32 i = 0; i < m_indices.size(); ++i) {
+		m_bounds[i] = bounds[m_indices[i]];
+	}
+	// children come after their parent, a reverse sweep visits both before it
+	for (Uint32 i = static_cast<Uint32>(m_nodes.size()); i-- > 0;) {
+		// nodes dropped by remove have no parent
+		if (i && m_parents[i] == none) { continue; }
+		refitNode(i);
+	}
+}
+
+void BVH::refitNode(const Uint32 &index) {
+	Node &node { m_nodes[index] };
+	node.bounds = { };
+	if (node.count) {
+		for (Uint32 j = node.first; j < node.first + node.count; ++j) {
+			node.bounds.grow(m_bounds[j]);
+		}
+	} else {
+		node.bounds.grow(m_nodes[node.first].bounds);
+		node.bounds.grow(m_nodes[node.first + 1].bounds);
+	}
+}
+
+void BVH::insert(const Uint32 &primitive, const AABB &box) {
+	remove(primitive);
+	if (box.empty()) { return; }
+	if (m_entries.size() <= primitive) { m_entries.resize(primitive + 1, none); }
+	const Uint32 entry { static_cast<Uint32>(m_indices.size()) };
+	m_indices.push_back(primitive);
+	m_bounds.push_back(box);
+	m_entries[primitive] = entry;
+	++m_size;
+	if (m_nodes.empty()) {
+		m_nodes.push_back({ box, entry, 1 });
+		m_parents.push_back(none);
+		m_leaves.push_back(0);
+		return;
+	}
+	// every box on the way down grows to enclose the new one, the child that grows least is taken
+	auto growth = [&](const Uint32 &node) {
+		AABB grown { m_nodes[node].bounds };
+		grown.grow(box);
+		return grown.area() - m_nodes[node].bounds.area();
+	};
+	Uint32 node { 0 };
+	while (!m_nodes[node].count) {
+		m_nodes[node].bounds.grow(box);
+		const Uint32 left { m_nodes[node].first };
+		node = growth(left) <= growth(left + 1) ? left : left + 1;
+	}
+	Node &leaf { m_nodes[node] };
+	leaf.bounds.grow(box);
+	// a leaf whose entries end at the new one takes it in place
+	if (leaf.count < max_leaf && leaf.first + leaf.count == entry) {
+		++leaf.count;
+		m_leaves.push_back(node);
+		return;
+	}
+	// otherwise the leaf moves down, next to a new leaf of the primitive
+	const Uint32 children { static_cast<Uint32>(m_nodes.size()) };
+	const Node moved { leaf.bounds, leaf.first, leaf.count };
+	m_nodes[node] = { moved.bounds, children, 0 };
+	m_nodes.push_back(moved);
+	m_nodes.push_back({ box, entry, 1 });
+	refitNode(children);
+	m_parents.push_back(node);
+	m_parents.push_back(node);
+	for (Uint32 i = moved.first; i < moved.first + moved.count; ++i) {
+		m_leaves[i] = children;
+	}
+	m_leaves.push_back(children + 1);
+}
+
+void BVH::remove(const Uint32 &primitive) {
+	if (primitive >= m_entries.size() || m_entries[primitive] == none) { return; }
+	const Uint32 entry { m_entries[primitive] };
+	m_entries[primitive] = none;
+	if (--m_size == 0) {
+		m_nodes.clear();
+		m_parents.clear();
+		m_indices.clear();
+		m_bounds.clear();
+		m_leaves.clear();
+		return;
+	}
+	// the leaf's last entry takes the place of the removed one
+	const Uint32 leaf { m_leaves[entry] };
+	const Uint32 last { m_nodes[leaf].first + m_nodes[leaf].count - 1 };
+	if (entry != last) {
+		m_indices[entry] = m_indices[last];
+		m_bounds[entry] = m_bounds[last];
+		m_entries[m_indices[entry]] = entry;
+	}
+	Uint32 changed { leaf };
+	if (--m_nodes[leaf].count == 0) {
+		// an empty leaf isn't the root while the tree holds primitives, its sibling takes the parent's place
+		const Uint32 parent { m_parents[leaf] };
+		const Uint32 sibling { leaf == m_nodes[parent].first ? leaf + 1 : leaf - 1 };
+		const Node &kept { m_nodes[parent] = m_nodes[sibling] };
+		if (kept.count) {
+			for (Uint32 i = kept.first; i < kept.first + kept.count; ++i) {
+				m_leaves[i] = parent;
+			}
+		} else {
+			m_parents[kept.first] = m_parents[kept.first + 1] = parent;
+		}
+		m_parents[leaf] = m_parents[sibling] = none;
+		changed = m_parents[parent];
+	}
+	// boxes above shrink back to what is left
+	for (Uint32 node = changed; node != none; node = m_parents[node]) {
+		refitNode(node);
+	}
+}
+
+// distance to where the ray enters box, std::nullopt if it misses or enters beyond t_max
+static std::optional<float> intersect(const AABB &box, const glm::vec3 &origin, const glm::vec3 &inv_direction, const float &t_max) {
+	const glm::vec3 t1 { (box.min - origin) * inv_direction };
+	const glm::vec3 t2 { (box.max - origin) * inv_direction };
+	const glm::vec3 near { glm::min(t1, t2) }, far { glm::max(t1, t2) };
+	const float t_enter { SDL_max(SDL_max(near.x, near.y), SDL_max(near.z, 0.0f)) };
+	const float t_exit { SDL_min(SDL_min(far.x, far.y), SDL_min(far.z, t_max)) };
+	if (t_enter > t_exit) { return std::nullopt; }
+	return t_enter;
+}
+
+std::optional<BVH::Hit> BVH::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float t_max, const ExactTest &exact) const {
+	if (m_nodes.empty()) { return std::nullopt; }
+	const glm::vec3 inv_direction { 1.0f / direction };
+	std::optional<Hit> closest;
+	// (node, entry distance), the stack only outgrows its buffer in very unbalanced trees
+	std::array<std::byte, 1024> scratch;
+	std::pmr::monotonic_buffer_resource stack_resource { scratch.data(), scratch.size() };
+	std::pmr::vector<std::pair<Uint32, float>> stack { &stack_resource };
+	if (const std::optional<float> t { intersect(m_nodes[0].bounds, origin, inv_direction, t_max) }; t) {
+		stack.emplace_back(0, t.value());
+	}
+	while (!stack.empty()) {
+		const auto [index, t_enter] { stack.back() };
+		stack.pop_back();
+		// a closer hit was found since this node was pushed
+		if (t_enter > t_max) { continue; }
+		const Node &node { m_nodes[index] };
+		if (node.count) {
+			for (Uint32 i = node.first; i < node.first + node.count; ++i) {
+				std::optional<float> t { intersect(m_bounds[i], origin, inv_direction, t_max) };
+				if (t && exact) { t = exact(m_indices[i], t.value(), t_max); }
+				if (t && t.value() <= t_max) {
+					t_max = t.value();
+					closest = Hit { m_indices[i], t.value() };
+				}
+			}
+			continue;
+		}
+		const std::optional<float> t_left { intersect(m_nodes[node.first].bounds, origin, inv_direction, t_max) };
+		const std::optional<float> t_right { intersect(m_nodes[node.first + 1].bounds, origin, inv_direction, t_max) };
+		// push the far child first so the near one is visited first
+		if (t_left && t_right) {
+			const bool left_near { t_left.value() <= t_right.value() };
+			stack.emplace_back(left_near ? node.first + 1 : node.first, left_near ? t_right.value() : t_left.value());
+			stack.emplace_back(left_near ? node.first : node.first + 1, left_near ? t_left.value() : t_right.value());
+		} else if (t_left) {
+			stack.emplace_back(node.first, t_left.value());
+		} else if (t_right) {
+			stack.emplace_back(node.first + 1, t_right.value());
+		}
+	}
+	return closest;
+}
+
+enum class Containment { outside, intersecting, inside };
+
+static Containment classify(const AABB &box, const std::array<glm::vec4, 6> &planes) {
+	Containment result { Containment::inside };
+	for (const glm::vec4 &plane : planes) {
+		const glm::vec3 normal { plane };
+		// corners furthest along & against the plane's normal
+		const glm::bvec3 along { glm::greaterThanEqual(normal, glm::vec3(0)) };
+		const glm::vec3 positive { glm::mix(box.min, box.max, along) };
+		const glm::vec3 negative { glm::mix(box.max, box.min, along) };
+		if (glm::dot(normal, positive) + plane.w < 0) { return Containment::outside; }
+		if (glm::dot(normal, negative) + plane.w < 0) { result = Containment::intersecting; }
+	}
+	return result;
+}
+
+void BVH::frustum(const std::array<glm::vec4, 6> &planes, std::pmr::vector<Uint32> &visible) const {
+	if (m_nodes.empty()) { return; }
+	// (node, inside every plane)
+	std::array<std::byte, 1024> scratch;
+	std::pmr::monotonic_buffer_resource stack_resource { scratch.data(), scratch.size() };
+	std::pmr::vector<std::pair<Uint32, bool>> stack { &stack_resource };
+	stack.emplace_back(0, false);
+	while (!stack.empty()) {
+		auto [index, inside] { stack.back() };
+		stack.pop_back();
+		const Node &node { m_nodes[index] };
+		if (!inside) {
+			const Containment containment { classify(node.bounds, planes) };
+			if (containment == Containment::outside) { continue; }
+			inside = containment == Containment::inside;
+		}
+		if (node.count) {
+			for (Uint32 i = node.first; i < node.first + node.count; ++i) {
+				if (inside || classify(m_bounds[i], planes) != Containment::outside) {
+					visible.push_back(m_indices[i]);
+				}
+			}
+		} else {
+			stack.emplace_back(node.first, inside);
+			stack.emplace_back(node.first + 1, inside);
+		}
+	}
+}
@@ -0,0 +1,441 @@
+#include "Benchmarks.hpp"
+#include <SDL3/SDL_init.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "App.hpp"
+#include "BVH.hpp"
+#include "Jobs.hpp"
+#include "Memory.hpp"
+#include "Pipelines.hpp"
+#include "Scene.hpp"
+
+static double elapsedMs(const Uint64 &start) {
+	return (SDL_GetTicksNS() - start) / 1e6;
+}
+
+// boxes of 0.5 to 2 units, the volume grows with the count so the density stays the same
+static std::vector<AABB> randomBoxes(const Uint32 &count, const float &extent, std::mt19937 &rng) {
+	std::uniform_real_distribution<float> position { -extent, extent }, size { 0.5f, 2.0f };
+	std::vector<AABB> boxes(count);
+	for (AABB &box : boxes) {
+		box.min = { position(rng), position(rng), position(rng) };
+		box.max = box.min + glm::vec3 { size(rng), size(rng), size(rng) };
+	}
+	return boxes;
+}
+
+// closest box along a ray by testing every box
+static std::optional<float> closestBox(const std::vector<AABB> &boxes, const glm::vec3 &origin, const glm::vec3 &direction) {
+	std::optional<float> closest;
+	for (const AABB &box : boxes) {
+		const glm::vec3 t1 { (box.min - origin) / direction }, t2 { (box.max - origin) / direction };
+		const glm::vec3 near { glm::min(t1, t2) }, far { glm::max(t1, t2) };
+		const float t_enter { SDL_max(SDL_max(near.x, near.y), SDL_max(near.z, 0.0f)) };
+		const float t_exit { SDL_min(SDL_min(far.x, far.y), far.z) };
+		if (t_enter <= t_exit && (!closest || t_enter < closest.value())) {
+			closest = t_enter;
+		}
+	}
+	return closest;
+}
+
+bool benchmarkBVH() {
+	JobSystem jobs;
+	jobs.init();
+	std::mt19937 rng { 1 };
+	bool agrees { true };
+	for (const Uint32 count : { 10'000u, 100'000u, 1'000'000u }) {
+		const float extent { 5.0f * std::cbrt(static_cast<float>(count)) };
+		std::vector<AABB> boxes { randomBoxes(count, extent, rng) };
+		BVH bvh;
+		Uint64 start { SDL_GetTicksNS() };
+		bvh.build(boxes);
+		const double serial_ms { elapsedMs(start) };
+		start = SDL_GetTicksNS();
+		bvh.build(boxes, &jobs);
+		const double parallel_ms { elapsedMs(start) };
+
+		// every object moves a little, as in a frame where everything is animated
+		for (AABB &box : boxes) {
+			box.min += glm::vec3 { 0.1f, 0.0f, 0.05f };
+			box.max += glm::vec3 { 0.1f, 0.0f, 0.05f };
+		}
+		start = SDL_GetTicksNS();
+		bvh.refit(boxes);
+		const double refit_ms { elapsedMs(start) };
+
+		// an asset of a thousand objects leaves & another one arrives, the rays below check the tree after it
+		constexpr Uint32 num_churned { 1'000 };
+		const std::vector<AABB> arriving { randomBoxes(num_churned, extent, rng) };
+		start = SDL_GetTicksNS();
+		for (Uint32 i = 0; i < num_churned; ++i) {
+			bvh.remove(i);
+		}
+		for (Uint32 i = 0; i < num_churned; ++i) {
+			boxes[i] = arriving[i];
+			bvh.insert(i, boxes[i]);
+		}
+		const double churn_ms { elapsedMs(start) };
+
+		// rays from inside the volume in random directions
+		constexpr Uint32 num_rays { 10'000 }, num_checked { 32 };
+		std::uniform_real_distribution<float> position { -extent, extent }, axis { -1.0f, 1.0f };
+		std::vector<std::pair<glm::vec3, glm::vec3>> rays(num_rays);
+		for (std::pair<glm::vec3, glm::vec3> &ray : rays) {
+			ray.first = { position(rng), position(rng), position(rng) };
+			ray.second = glm::normalize(glm::vec3 { axis(rng), axis(rng), axis(rng) } + glm::vec3(1e-4f));
+		}
+		Uint32 hits { 0 };
+		start = SDL_GetTicksNS();
+		for (const std::pair<glm::vec3, glm::vec3> &ray : rays) {
+			hits += bvh.raycast(ray.first, ray.second).has_value();
+		}
+		const double ray_ms { elapsedMs(start) };
+		for (Uint32 i = 0; i < num_checked; ++i) {
+			const std::optional<BVH::Hit> hit { bvh.raycast(rays[i].first, rays[i].second) };
+			const std::optional<float> expected { closestBox(boxes, rays[i].first, rays[i].second) };
+			if (hit.has_value() != expected.has_value() || (hit && std::abs(hit->t - expected.value()) > 1e-3f)) {
+				SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "BVH ray %u disagrees with a linear scan", i);
+				agrees = false;
+			}
+		}
+
+		// views from random points in the volume
+		constexpr Uint32 num_views { 100 };
+		std::uniform_real_distribution<float> angle { 0.0f, 2.0f * SDL_PI_F };
+		std::pmr::vector<Uint32> visible;
+		Uint64 num_visible { 0 };
+		start = SDL_GetTicksNS();
+		for (Uint32 i = 0; i < num_views; ++i) {
+			const Camera camera { { position(rng), position(rng), position(rng) }, glm::angleAxis(angle(rng), glm::vec3 { 0, 1, 0 }), { 1200, 900 } };
+			visible.clear();
+			bvh.frustum(camera.frustum(), visible);
+			num_visible += visible.size();
+		}
+		const double frustum_ms { elapsedMs(start) };
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "BVH over %u boxes: build %.2f ms (%.2f ms on %u threads), refit %.2f ms, remove & insert %u %.2f ms, %zu nodes",
+				count, serial_ms, parallel_ms, jobs.concurrency(), refit_ms, num_churned, churn_ms, bvh.nodes().size());
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "\t%u rays: %.1f ns per ray, %u hits, %u frustum queries: %.3f ms per query, %llu visible on average",
+				num_rays, ray_ms * 1e6 / num_rays, hits, num_views, frustum_ms / num_views, static_cast<unsigned long long>(num_visible / num_views));
+	}
+	jobs.quit();
+	return agrees;
+}
+
+// a few rounds of integer mixing, the same result whichever thread runs it
+static Uint64 mix(Uint64 x) {
+	for (Uint32 round = 0; round < 16; ++round) {
+		x *= 0x9E3779B97F4A7C15ull;
+		x ^= x >> 31;
+	}
+	return x;
+}
+
+bool benchmarkJobs() {
+	constexpr Uint32 num_jobs { 100'000 }, chain_length { 10'000 };
+	constexpr Uint32 count { 1u << 22 }, grain { 1u << 14 };
+	Uint64 expected { 0 };
+	for (Uint32 i = 0; i < count; ++i) {
+		expected += mix(i);
+	}
+	bool agrees { true };
+	double base_ms { 0 };
+	std::vector<JobHandle> handles;
+	handles.reserve(num_jobs);
+	for (const Uint32 workers : { 1u, 2u, 4u, 8u, 16u, 32u }) {
+		JobSystem jobs;
+		jobs.init(workers);
+		std::atomic<Uint32> ran { 0 };
+
+		// empty jobs from the main thread, workers steal them while the main thread runs what's left
+		Uint64 start { SDL_GetTicksNS() };
+		for (Uint32 i = 0; i < num_jobs; ++i) {
+			handles.push_back(jobs.submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }));
+		}
+		const double submit_ms { elapsedMs(start) };
+		for (const JobHandle &handle : handles) {
+			jobs.wait(handle);
+		}
+		const double stolen_ms { elapsedMs(start) };
+		handles.clear();
+
+		// the same jobs submitted from a worker, pushed & popped at the back of its own deque
+		start = SDL_GetTicksNS();
+		jobs.wait(jobs.submit([&] {
+			for (Uint32 i = 0; i < num_jobs; ++i) {
+				handles.push_back(jobs.submit([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }));
+			}
+			for (const JobHandle &handle : handles) {
+				jobs.wait(handle);
+			}
+		}));
+		const double local_ms { elapsedMs(start) };
+		handles.clear();
+		if (ran != 2 * num_jobs) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%u of %u jobs ran on %u workers", ran.load(), 2 * num_jobs, workers);
+			agrees = false;
+		}
+
+		// every job depends on the previous one, each runs as the continuation of the last
+		std::atomic<Uint32> position { 0 };
+		bool ordered { true };
+		start = SDL_GetTicksNS();
+		JobHandle previous;
+		for (Uint32 i = 0; i < chain_length; ++i) {
+			const JobHandle dependencies[1] { previous };
+			previous = jobs.submit([&position, &ordered, i] {
+				if (position.fetch_add(1) != i) { ordered = false; }
+			}, previous ? std::span<const JobHandle> { dependencies } : std::span<const JobHandle> { });
+		}
+		jobs.wait(previous);
+		const double chain_ms { elapsedMs(start) };
+		previous.reset();
+		if (!ordered || position != chain_length) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "A chain of dependent jobs ran out of order on %u workers", workers);
+			agrees = false;
+		}
+
+		std::atomic<Uint64> sum { 0 };
+		start = SDL_GetTicksNS();
+		jobs.parallelFor(count, grain, [&sum](Uint32 begin, Uint32 end) {
+			Uint64 partial { 0 };
+			for (Uint32 i = begin; i < end; ++i) {
+				partial += mix(i);
+			}
+			sum.fetch_add(partial, std::memory_order_relaxed);
+		});
+		const double for_ms { elapsedMs(start) };
+		if (sum != expected) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "parallelFor on %u workers visited elements more or less than once", workers);
+			agrees = false;
+		}
+		if (!base_ms) { base_ms = for_ms; }
+
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Jobs on %u workers (%u threads): submit %.0f ns, stolen %.0f ns, local %.0f ns, chained %.0f ns per job",
+				workers, jobs.concurrency(), submit_ms * 1e6 / num_jobs, stolen_ms * 1e6 / num_jobs, local_ms * 1e6 / num_jobs, chain_ms * 1e6 / chain_length);
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "\tparallelFor over %u elements in chunks of %u: %.2f ms, %.2fx the 1 worker time",
+				count, grain, for_ms, base_ms / for_ms);
+		jobs.quit();
+	}
+	return agrees;
+}
+
+// name -> value lines, as written by writeResults
+using BenchmarkResults = std::map<std::string, double>;
+
+static BenchmarkResults readResults(const std::filesystem::path &path) {
+	BenchmarkResults results;
+	std::size_t size { 0 };
+	char *text { static_cast<char*>(SDL_LoadFile(path.string().c_str(), &size)) };
+	if (!text) { return results; }
+	std::istringstream lines { std::string(text, size) };
+	SDL_free(text);
+	std::string name;
+	double value;
+	while (lines >> name >> value) {
+		results[name] = value;
+	}
+	return results;
+}
+
+static bool writeResults(const std::filesystem::path &path, const BenchmarkResults &results) {
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+	std::string text;
+	for (const std::pair<const std::string, double> &result : results) {
+		text += result.first + " " + std::to_string(result.second) + "\n";
+	}
+	return SDL_SaveFile(path.string().c_str(), text.data(), text.size());
+}
+
+struct OrbitTimes {
+	double frame_ms, cpu_ms; // per frame
+};
+// orbit the whole scene once, close enough that some of it is out of view, std::nullopt if a frame failed
+static std::optional<OrbitTimes> orbit(App &app, const Uint32 &frames) {
+	const Scene &scene { app.scene() };
+	AABB bounds;
+	for (const Mesh &mesh : scene.objects()) {
+		if (!mesh.num_draws) { continue; }
+		bounds.grow(AABB { mesh.min, mesh.max }.transformed(scene.assets().at(mesh.asset).transform * mesh.model_mat()));
+	}
+	const glm::vec3 center { bounds.center() };
+	const float radius { glm::distance(bounds.min, bounds.max) * 0.5f };
+	app.camera().near_far = { 0.1f, radius * 4.0f };
+	// cpu time of every thread, waiting on the gpu costs next to nothing
+	const std::clock_t cpu_start { std::clock() };
+	const Uint64 start { SDL_GetTicksNS() };
+	for (Uint32 frame = 0; frame < frames; ++frame) {
+		const float angle { 2.0f * SDL_PI_F * frame / frames };
+		const glm::vec3 pos { center + glm::vec3 { std::cos(angle), 0.5f, std::sin(angle) } * radius * 1.2f };
+		app.camera().place(pos, glm::quat_cast(glm::lookAt(pos, center, { 0, 1, 0 })));
+		if (app.iterate() != SDL_APP_CONTINUE) { return std::nullopt; }
+	}
+	if (!frames) { return OrbitTimes { 0, 0 }; }
+	const double cpu_ms { 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC };
+	return OrbitTimes { elapsedMs(start) / frames, cpu_ms / frames };
+}
+
+// SDL_Init & a gpu device to render with, logs why the benchmark is skipped otherwise
+static bool gpuAvailable() {
+	// gpu backends load through the video subsystem, no window is opened
+	if (!SDL_Init(SDL_INIT_VIDEO)) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s, SDL_Init failed\n\t%s", benchmark_skipped, SDL_GetError());
+		return false;
+	}
+	if (!SDL_GPUSupportsShaderFormats(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL, nullptr)) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s, no gpu device", benchmark_skipped);
+		SDL_Quit();
+		return false;
+	}
+	return true;
+}
+
+// frames run before anything is timed
+static constexpr Uint32 warmup_frames { 16 };
+
+bool benchmarkCulling(const std::vector<std::filesystem::path> &scenes, const Uint32 &frames) {
+	if (!gpuAvailable()) { return true; }
+	bool ok { true };
+	// the fewest objects culling on the gpu won at, 0 while the cpu won every scene so far
+	size_t crossover { 0 };
+	for (const std::filesystem::path &path : scenes) {
+		App app;
+		ok = app.init({ .headless = true }) == SDL_APP_CONTINUE && app.loadGLTF(path);
+		// the first frames build the BVH & stream textures, neither mode should pay for them
+		ok = ok && orbit(app, warmup_frames).has_value();
+		std::optional<OrbitTimes> times[2];
+		for (const bool gpu : { true, false }) {
+			if (!ok) { break; }
+			app.cullOnGpu(gpu);
+			times[gpu] = orbit(app, frames);
+			ok = times[gpu].has_value();
+		}
+		const size_t objects { app.scene().objects().size() };
+		app.quit();
+		if (!ok) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Culling benchmark failed on %s", path.string().c_str());
+			break;
+		}
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s, %zu objects: gpu culling %.3f ms per frame (%.3f ms cpu), cpu culling %.3f ms per frame (%.3f ms cpu)",
+				path.filename().string().c_str(), objects, times[1]->frame_ms, times[1]->cpu_ms, times[0]->frame_ms, times[0]->cpu_ms);
+		if (times[1]->frame_ms < times[0]->frame_ms && (!crossover || objects < crossover)) {
+			crossover = objects;
+		}
+	}
+	SDL_Quit();
+	if (!ok) { return false; }
+	if (crossover) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Culling on the gpu is faster from %zu objects on", crossover);
+	} else {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Culling on the cpu was faster in every scene");
+	}
+	return true;
+}
+
+// how long each still camera run of benchmarkScene lasts
+static constexpr Uint64 still_ns { 2 * SDL_NS_PER_SECOND };
+
+bool benchmarkScene(const SceneBenchmark &options) {
+	// results are only written when asked to, a test run never touches the baselines
+	const BenchmarkResults baseline { options.update_baseline ? BenchmarkResults { } : readResults(options.baseline) };
+	// a benchmark without its baseline can't catch a regression, that is a failure & not a pass
+	if (!options.baseline.empty() && baseline.empty() && !options.update_baseline) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "No baseline at %s, record one with --update-baseline",
+				options.baseline.string().c_str());
+		return false;
+	}
+	if (!gpuAvailable()) { return true; }
+	// the app's own frame: pacer, frame graph, cull, render, outline composite & fences, into an offscreen composite
+	App app;
+	bool ok { app.init({ .headless = true }) == SDL_APP_CONTINUE };
+
+	BenchmarkResults results;
+	const Uint64 load_start { SDL_GetTicksNS() };
+	if (ok && !app.loadGLTF(options.scene)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Benchmark failed to load %s", options.scene.string().c_str());
+		ok = false;
+	}
+	results["load_ms"] = elapsedMs(load_start);
+	if (ok && options.compare_log_priority) {
+		// files & parser buffers are warm from the first load, only the log priority differs between these two
+		const SDL_LogPriority priority { SDL_GetLogPriority(SDL_LOG_CATEGORY_APPLICATION) };
+		for (const SDL_LogPriority load_priority : { SDL_LOG_PRIORITY_INFO, SDL_LOG_PRIORITY_DEBUG }) {
+			app.removeGLTF();
+			SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, load_priority);
+			const Uint64 start { SDL_GetTicksNS() };
+			ok = ok && app.loadGLTF(options.scene);
+			results[load_priority == SDL_LOG_PRIORITY_DEBUG ? "load_ms_debug_log" : "load_ms_info_log"] = elapsedMs(start);
+		}
+		SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, priority);
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s loads in %.2f ms at info priority, %.2f ms at debug priority",
+				options.scene.filename().string().c_str(), results["load_ms_info_log"], results["load_ms_debug_log"]);
+	}
+
+	if (ok) {
+		const std::optional<OrbitTimes> orbit_times { orbit(app, options.frames) };
+		ok = orbit_times.has_value();
+		results["frame_ms"] = orbit_times ? orbit_times->frame_ms : 0.0;
+		results["frame_cpu_ms"] = orbit_times ? orbit_times->cpu_ms : 0.0;
+
+		// a still camera at 60 fps, idle frames only redo the composite & sleep until something happens
+		app.pacer().setFrameCap(60);
+		for (const bool elide : { true, false }) {
+			app.elideIdleFrames(elide);
+			Uint32 frames { 0 };
+			const std::clock_t still_cpu_start { std::clock() };
+			const Uint64 still_start { SDL_GetTicksNS() };
+			while (ok && SDL_GetTicksNS() - still_start < still_ns) {
+				ok = app.iterate() == SDL_APP_CONTINUE;
+				++frames;
+			}
+			const double still_cpu_ms { 1000.0 * (std::clock() - still_cpu_start) / CLOCKS_PER_SEC };
+			const double seconds { elapsedMs(still_start) / 1000.0 };
+			results[elide ? "still_cpu_ms_per_s" : "still_cpu_ms_per_s_unelided"] = still_cpu_ms / seconds;
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Still camera %s idle elision: %.1f ms cpu per second over %u frames",
+					elide ? "with" : "without", still_cpu_ms / seconds, frames);
+		}
+		app.elideIdleFrames(true);
+		app.pacer().setFrameCap(0);
+	}
+	results["peak_rss_mb"] = peakResidentBytes() / (1024.0 * 1024.0);
+	app.quit();
+	SDL_Quit();
+	if (!ok) { return false; }
+
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s: load %.2f ms, %.3f ms per frame, %.3f ms cpu per frame over %u frames, peak rss %.1f MiB",
+			options.scene.filename().string().c_str(), results["load_ms"], results["frame_ms"], results["frame_cpu_ms"], options.frames, results["peak_rss_mb"]);
+	if (options.update_baseline) {
+		if (options.baseline.empty()) { return true; }
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Recording baseline %s", options.baseline.string().c_str());
+		return writeResults(options.baseline, results);
+	}
+	bool regressed { false };
+	for (const std::pair<const std::string, double> &result : results) {
+		const BenchmarkResults::const_iterator expected { baseline.find(result.first) };
+		if (expected == baseline.end() || expected->second <= 0) { continue; }
+		const double change { result.second / expected->second - 1.0 };
+		if (change > options.threshold) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Regression: %s %.3f, baseline %.3f (+%.0f%%)",
+					result.first.c_str(), result.second, expected->second, change * 100.0);
+			regressed = true;
+		}
+	}
+	return !regressed;
+}
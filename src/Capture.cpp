@@ -0,0 +1,286 @@
+#include "Capture.hpp"
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+
+#include <string>
+#include <system_error>
+#include <vector>
+
+// crc of png chunks, zlib's polynomial
+static Uint32 chunkCRC(const Uint8 *data, const std::size_t &size, Uint32 crc = 0) {
+	static const std::array<Uint32, 256> table { [] {
+		std::array<Uint32, 256> result;
+		for (Uint32 n = 0; n < 256; ++n) {
+			Uint32 c { n };
+			for (Uint32 k = 0; k < 8; ++k) {
+				c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			result[n] = c;
+		}
+		return result;
+	}() };
+	crc = ~crc;
+	for (std::size_t i = 0; i < size; ++i) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void appendBigEndian(std::vector<Uint8> &out, const Uint32 &value) {
+	out.push_back(static_cast<Uint8>(value >> 24));
+	out.push_back(static_cast<Uint8>(value >> 16));
+	out.push_back(static_cast<Uint8>(value >> 8));
+	out.push_back(static_cast<Uint8>(value));
+}
+
+// fill in the length of the chunk starting at chunk_start & append its crc, its data ends the buffer
+static void finishChunk(std::vector<Uint8> &out, const std::size_t &chunk_start) {
+	const Uint32 length { static_cast<Uint32>(out.size() - chunk_start - 8) };
+	for (Uint32 i = 0; i < 4; ++i) {
+		out[chunk_start + i] = static_cast<Uint8>(length >> (24 - i * 8));
+	}
+	appendBigEndian(out, chunkCRC(out.data() + chunk_start + 4, out.size() - chunk_start - 4));
+}
+
+// encode 4 byte pixels as an 8 bit RGB png, deflate blocks are stored uncompressed,
+// encoding runs at memory speed & the frames are meant to be compressed offline
+static std::vector<Uint8> encodePNG(const Uint8 *pixels, const Uint32 &width, const Uint32 &height, const bool &bgra) {
+	const Uint32 row_bytes { 1 + width * 3 }; // filter type, then RGB
+	const std::size_t raw_bytes { static_cast<std::size_t>(row_bytes) * height };
+	constexpr Uint32 max_block { 65535 };
+	const std::size_t blocks { SDL_max((raw_bytes + max_block - 1) / max_block, std::size_t { 1 }) };
+	std::vector<Uint8> out;
+	out.reserve(64 + raw_bytes + blocks * 5 + 6);
+	const Uint8 signature[8] { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	out.insert(out.end(), signature, signature + sizeof(signature));
+
+	std::size_t chunk_start { out.size() };
+	appendBigEndian(out, 0);
+	out.insert(out.end(), { 'I', 'H', 'D', 'R' });
+	appendBigEndian(out, width);
+	appendBigEndian(out, height);
+	// 8 bit truecolor, deflate, adaptive filtering, no interlace
+	out.insert(out.end(), { 8, 2, 0, 0, 0 });
+	finishChunk(out, chunk_start);
+
+	chunk_start = out.size();
+	appendBigEndian(out, 0);
+	out.insert(out.end(), { 'I', 'D', 'A', 'T' });
+	out.insert(out.end(), { 0x78, 0x01 }); // zlib header, no compression
+	// rows are converted straight into the stored blocks, a block can end mid row
+	Uint32 adler_a { 1 }, adler_b { 0 };
+	std::size_t written { 0 };
+	Uint32 block_left { 0 };
+	// the adler sums can't overflow within 5552 bytes, the modulo is only taken that often
+	Uint32 adler_pending { 0 };
+	auto put = [&](const Uint8 &byte) {
+		if (!block_left) {
+			block_left = static_cast<Uint32>(SDL_min(raw_bytes - written, std::size_t { max_block }));
+			out.push_back(written + block_left == raw_bytes ? 1 : 0);
+			out.push_back(static_cast<Uint8>(block_left));
+			out.push_back(static_cast<Uint8>(block_left >> 8));
+			out.push_back(static_cast<Uint8>(~block_left));
+			out.push_back(static_cast<Uint8>(~block_left >> 8));
+		}
+		out.push_back(byte);
+		--block_left;
+		++written;
+		adler_a += byte;
+		adler_b += adler_a;
+		if (++adler_pending == 5552) {
+			adler_a %= 65521;
+			adler_b %= 65521;
+			adler_pending = 0;
+		}
+	};
+	for (Uint32 y = 0; y < height; ++y) {
+		put(0);
+		const Uint8 *row { pixels + static_cast<std::size_t>(y) * width * 4 };
+		for (Uint32 x = 0; x < width; ++x) {
+			const Uint8 *pixel { row + x * 4 };
+			put(pixel[bgra ? 2 : 0]);
+			put(pixel[1]);
+			put(pixel[bgra ? 0 : 2]);
+		}
+	}
+	adler_a %= 65521;
+	adler_b %= 65521;
+	appendBigEndian(out, (adler_b << 16) | adler_a);
+	finishChunk(out, chunk_start);
+
+	chunk_start = out.size();
+	appendBigEndian(out, 0);
+	out.insert(out.end(), { 'I', 'E', 'N', 'D' });
+	finishChunk(out, chunk_start);
+	return out;
+}
+
+void FrameCapture::init(SDL_GPUDevice *gpu, JobSystem *jobs) {
+	m_gpu = gpu;
+	m_jobs = jobs;
+}
+
+void FrameCapture::quit() {
+	m_active = false;
+	for (Slot &slot : m_slots) {
+		if (slot.fence) { SDL_WaitForGPUFences(m_gpu, true, &slot.fence, 1); }
+	}
+	// every download is done, encode what is left & wait for it
+	poll();
+	for (Slot &slot : m_slots) {
+		if (slot.encode) { m_jobs->wait(slot.encode); }
+	}
+	poll();
+	for (Slot &slot : m_slots) {
+		if (slot.buffer.get()) { slot.buffer.release(); }
+	}
+	if (m_target.get()) { m_target.release(); }
+}
+
+bool FrameCapture::start(const std::filesystem::path &directory, const CaptureSource &source) {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Can't create capture directory %s\n\t%s", directory.string().c_str(), error.message().c_str());
+		return false;
+	}
+	m_directory = directory;
+	m_source = source;
+	m_active = true;
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Capturing the %s to %s",
+			source == CaptureSource::composite ? "composite" : "color target", directory.string().c_str());
+	return true;
+}
+
+void FrameCapture::stop() {
+	m_active = false;
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Capture stopped");
+}
+
+SDL_GPUTexture* FrameCapture::target(const Uint32 &width, const Uint32 &height, const SDL_GPUTextureFormat &format) {
+	if (m_target.get() && m_target.info.width == width && m_target.info.height == height && m_target.info.format == format) {
+		return m_target.get();
+	}
+	// downloads in flight keep the old texture alive until they are done
+	if (m_target.get()) { m_target.release(); }
+	m_target.info = {
+		.type = SDL_GPU_TEXTURETYPE_2D,
+		.format = format,
+		// sampled by the blit to the window
+		.usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = width,
+		.height = height,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+		.sample_count = SDL_GPU_SAMPLECOUNT_1,
+	};
+	if (!m_target.create(m_gpu)) { return nullptr; }
+	return m_target.get();
+}
+
+void FrameCapture::capture(SDL_GPUTexture *texture, const SDL_GPUTextureFormat &format, const Uint32 &width, const Uint32 &height, const Uint64 &frame) {
+	switch(format) {
+	case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM:
+	case SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB:
+	case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM:
+	case SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB:
+		break;
+	default:
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Can't capture texture format %d, capture stopped", format);
+		stop();
+		return;
+	}
+	Slot *free_slot { nullptr };
+	for (Slot &slot : m_slots) {
+		if (slot.state == Slot::State::free) {
+			free_slot = &slot;
+			break;
+		}
+	}
+	if (!free_slot) {
+		++m_dropped;
+		return;
+	}
+	Slot &slot { *free_slot };
+	const Uint32 bytes { width * height * 4 };
+	if (!slot.buffer.get() || slot.buffer.info.size < bytes) {
+		if (slot.buffer.get()) { slot.buffer.release(); }
+		slot.buffer.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+			.size = bytes,
+		};
+		if (!slot.buffer.create(m_gpu)) {
+			++m_dropped;
+			return;
+		}
+	}
+	// submitted after the frame, so the download sees everything the frame rendered
+	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(m_gpu) };
+	if (!cmdbuf) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_AcquireGPUCommandBuffer failed\n\t%s", SDL_GetError());
+		++m_dropped;
+		return;
+	}
+	const SDL_GPUTextureRegion source { .texture = texture, .w = width, .h = height, .d = 1 };
+	const SDL_GPUTextureTransferInfo destination {
+		.transfer_buffer = slot.buffer.get(),
+		.pixels_per_row = width,
+		.rows_per_layer = height,
+	};
+	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
+	SDL_DownloadFromGPUTexture(copypass, &source, &destination);
+	SDL_EndGPUCopyPass(copypass);
+	slot.fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+	if (!slot.fence) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_SubmitGPUCommandBufferAndAcquireFence failed\n\t%s", SDL_GetError());
+		++m_dropped;
+		return;
+	}
+	slot.state = Slot::State::downloading;
+	slot.format = format;
+	slot.width = width;
+	slot.height = height;
+	slot.frame = frame;
+}
+
+Uint32 FrameCapture::poll() {
+	Uint32 written { 0 };
+	for (Slot &slot : m_slots) {
+		if (slot.state == Slot::State::downloading && SDL_QueryGPUFence(m_gpu, slot.fence)) {
+			SDL_ReleaseGPUFence(m_gpu, slot.fence);
+			slot.fence = nullptr;
+			// stays mapped while the background thread encodes, nothing else touches the slot until then
+			slot.pixels = static_cast<const Uint8*>(SDL_MapGPUTransferBuffer(m_gpu, slot.buffer.get(), false));
+			if (!slot.pixels) {
+				slot.state = Slot::State::free;
+				continue;
+			}
+			slot.state = Slot::State::encoding;
+			slot.written = false;
+			const std::string path { (m_directory / ("frame_" + std::to_string(slot.frame) + ".png")).string() };
+			const bool bgra { slot.format == SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM || slot.format == SDL_GPU_TEXTUREFORMAT_B8G8R8A8_UNORM_SRGB };
+			slot.encode = m_jobs->submitBackground([&slot, path, bgra] {
+				const std::vector<Uint8> png { encodePNG(slot.pixels, slot.width, slot.height, bgra) };
+				if (SDL_SaveFile(path.c_str(), png.data(), png.size())) {
+					slot.written = true;
+				} else {
+					SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Can't write %s\n\t%s", path.c_str(), SDL_GetError());
+				}
+			});
+		} else if (slot.state == Slot::State::encoding && slot.encode->done) {
+			SDL_UnmapGPUTransferBuffer(m_gpu, slot.buffer.get());
+			slot.pixels = nullptr;
+			slot.encode = nullptr;
+			slot.state = Slot::State::free;
+			if (slot.written) { ++written; }
+		}
+	}
+	return written;
+}
+
+Uint32 FrameCapture::dropped() {
+	const Uint32 dropped { m_dropped };
+	m_dropped = 0;
+	return dropped;
+}
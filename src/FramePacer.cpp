@@ -0,0 +1,117 @@
+#include "FramePacer.hpp"
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+static const char* presentModeName(const SDL_GPUPresentMode &mode) {
+	switch(mode) {
+	case SDL_GPU_PRESENTMODE_VSYNC:
+		return "vsync";
+	case SDL_GPU_PRESENTMODE_IMMEDIATE:
+		return "immediate";
+	case SDL_GPU_PRESENTMODE_MAILBOX:
+		return "mailbox";
+	default:
+		return "unknown";
+	}
+}
+
+bool FramePacer::init(SDL_GPUDevice *gpu, SDL_Window *window) {
+	m_gpu = gpu;
+	m_window = window;
+	// mailbox presents the newest frame without tearing, fall back to vsync which is always supported
+	if (m_window && SDL_WindowSupportsGPUPresentMode(m_gpu, m_window, SDL_GPU_PRESENTMODE_MAILBOX)) {
+		m_present_mode = SDL_GPU_PRESENTMODE_MAILBOX;
+	}
+	return apply();
+}
+
+bool FramePacer::apply() {
+	if (m_window && !SDL_SetGPUSwapchainParameters(m_gpu, m_window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, m_present_mode)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_SetGPUSwapchainParameters failed:\n\t%s", SDL_GetError());
+		return false;
+	}
+	if (!SDL_SetGPUAllowedFramesInFlight(m_gpu, m_frames_in_flight)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_SetGPUAllowedFramesInFlight failed:\n\t%s", SDL_GetError());
+		return false;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Present mode %s, %u frames in flight, frame cap %u",
+			presentModeName(m_present_mode), m_frames_in_flight, m_fps_cap);
+	return true;
+}
+
+void FramePacer::limit() {
+	if (!m_fps_cap) { return; }
+	const Uint64 period { SDL_NS_PER_SECOND / m_fps_cap };
+	const Uint64 now { SDL_GetTicksNS() };
+	// more than a frame behind, don't rush to catch up
+	if (m_next_frame + period < now) {
+		m_next_frame = now;
+	}
+	if (now < m_next_frame) {
+		SDL_DelayPrecise(m_next_frame - now);
+	}
+	m_next_frame += period;
+}
+
+Uint32 FramePacer::advance() {
+	const Uint64 now { SDL_GetTicksNS() };
+	if (!m_last_advance) { m_last_advance = now; }
+	m_accumulator += now - m_last_advance;
+	m_last_advance = now;
+	Uint32 ticks { static_cast<Uint32>(m_accumulator / tick_ns) };
+	m_accumulator -= ticks * tick_ns;
+	if (ticks > max_ticks) {
+		ticks = max_ticks;
+	}
+	return ticks;
+}
+
+void FramePacer::cyclePresentMode() {
+	const SDL_GPUPresentMode modes[3] {
+		SDL_GPU_PRESENTMODE_VSYNC,
+		SDL_GPU_PRESENTMODE_MAILBOX,
+		SDL_GPU_PRESENTMODE_IMMEDIATE,
+	};
+	Uint32 current { 0 };
+	while (current < SDL_arraysize(modes) && modes[current] != m_present_mode) { ++current; }
+	for (Uint32 i = 1; i <= SDL_arraysize(modes); ++i) {
+		const SDL_GPUPresentMode next { modes[(current + i) % SDL_arraysize(modes)] };
+		if (SDL_WindowSupportsGPUPresentMode(m_gpu, m_window, next)) {
+			m_present_mode = next;
+			break;
+		}
+	}
+	apply();
+}
+
+void FramePacer::cycleFramesInFlight() {
+	m_frames_in_flight = m_frames_in_flight % max_frames_in_flight + 1;
+	apply();
+}
+
+void FramePacer::cycleFrameCap() {
+	const Uint32 caps[4] { 0, 30, 60, 120 };
+	Uint32 current { 0 };
+	while (current < SDL_arraysize(caps) && caps[current] != m_fps_cap) { ++current; }
+	setFrameCap(caps[(current + 1) % SDL_arraysize(caps)]);
+}
+
+void FramePacer::setFrameCap(const Uint32 &fps) {
+	m_fps_cap = fps;
+	m_next_frame = SDL_GetTicksNS();
+	apply();
+}
+
+void FramePacer::input(const Uint64 &timestamp) {
+	if (!m_oldest_input || timestamp < m_oldest_input) {
+		m_oldest_input = timestamp;
+	}
+}
+
+float FramePacer::submitted() {
+	if (!m_oldest_input) { return 0; }
+	const Uint64 now { SDL_GetTicksNS() };
+	const float latency_ms { now > m_oldest_input ? (now - m_oldest_input) / 1e6f : 0.0f };
+	m_oldest_input = 0;
+	return latency_ms;
+}
@@ -1,59 +1,164 @@
 #include "GPUResources.hpp"
 #include <SDL3/SDL_filesystem.h>
 
-// load a shader
-SDL_GPUShader* createShader(SDL_GPUDevice *gpu, GPUResource<SHADER> *shader, const std::string &filename, const Uint32 &num_samplers, const Uint32 &num_storage_textures, const Uint32 &num_storage_buffers, const Uint32 &num_uniform_buffers) {
-	// Auto-detect the shader stage from the file name for convenience
-	SDL_GPUShaderStage stage;
-	if (filename.contains(".vert")) {
-		stage = SDL_GPU_SHADERSTAGE_VERTEX;
-	} else if (filename.contains(".frag")) {
-		stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-	} else {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid shader stage!");
-		return nullptr;
+#include <array>
+#include <mutex>
+
+Uint64 textureBytes(const SDL_GPUTextureCreateInfo &info) {
+	Uint64 result { 0 };
+	for (Uint32 level = 0; level < info.num_levels; ++level) {
+		// 3d textures shrink in depth too, layers don't
+		const Uint32 depth { info.type == SDL_GPU_TEXTURETYPE_3D ? SDL_max(info.layer_count_or_depth >> level, 1u) : info.layer_count_or_depth };
+		result += SDL_CalculateGPUTextureFormatSize(info.format, SDL_max(info.width >> level, 1u), SDL_max(info.height >> level, 1u), depth);
+	}
+	return result;
+}
+
+namespace GPUResourceRegistry {
+	static std::mutex mutex;
+	static std::array<GPUResourceStats, resource_type_count> registry;
+
+	static const char* description(const RESOURCE_TYPES &type) {
+		switch(type) {
+		case TEXTURE: return GPUResourceTraits<TEXTURE>::description;
+		case SAMPLER: return GPUResourceTraits<SAMPLER>::description;
+		case BUFFER: return GPUResourceTraits<BUFFER>::description;
+		case TRANSFER_BUFFER: return GPUResourceTraits<TRANSFER_BUFFER>::description;
+		case SHADER: return GPUResourceTraits<SHADER>::description;
+		case GRAPHICS_PIPELINE: return GPUResourceTraits<GRAPHICS_PIPELINE>::description;
+		case COMPUTE_PIPELINE: return GPUResourceTraits<COMPUTE_PIPELINE>::description;
+		}
+		return "Resource";
+	}
+
+	void created(const RESOURCE_TYPES &type, const Uint64 &bytes) {
+		std::lock_guard lock { mutex };
+		GPUResourceStats &stats { registry[type] };
+		++stats.created;
+		++stats.live;
+		stats.bytes += bytes;
+		stats.max_live = SDL_max(stats.max_live, stats.live);
+		stats.max_bytes = SDL_max(stats.max_bytes, stats.bytes);
+	}
+
+	void failed(const RESOURCE_TYPES &type) {
+		std::lock_guard lock { mutex };
+		++registry[type].failed;
+	}
+
+	void released(const RESOURCE_TYPES &type, const Uint64 &bytes) {
+		std::lock_guard lock { mutex };
+		GPUResourceStats &stats { registry[type] };
+		--stats.live;
+		stats.bytes -= bytes;
+	}
+
+	GPUResourceStats stats(const RESOURCE_TYPES &type) {
+		std::lock_guard lock { mutex };
+		return registry[type];
+	}
+
+	Uint64 liveBytes() {
+		std::lock_guard lock { mutex };
+		Uint64 result { 0 };
+		for (const GPUResourceStats &stats : registry) {
+			result += stats.bytes;
+		}
+		return result;
+	}
+
+	void log() {
+		std::lock_guard lock { mutex };
+		for (Uint32 type = 0; type < resource_type_count; ++type) {
+			const GPUResourceStats &stats { registry[type] };
+			if (!stats.created && !stats.failed) { continue; }
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s: %u live (%u max), %llu bytes (%llu max), %llu created, %llu failed",
+					description(static_cast<RESOURCE_TYPES>(type)), stats.live, stats.max_live,
+					static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long long>(stats.max_bytes),
+					static_cast<unsigned long long>(stats.created), static_cast<unsigned long long>(stats.failed));
+		}
+	}
+
+	bool reportLeaks() {
+		std::lock_guard lock { mutex };
+		bool clean { true };
+		for (Uint32 type = 0; type < resource_type_count; ++type) {
+			const GPUResourceStats &stats { registry[type] };
+			if (!stats.live) { continue; }
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Leaked %u %s objects, %llu bytes",
+					stats.live, description(static_cast<RESOURCE_TYPES>(type)), static_cast<unsigned long long>(stats.bytes));
+			clean = false;
+		}
+		return clean;
 	}
+}
+
+// shader code loaded from disk for the backend's shader format
+struct ShaderCode {
+	void *code { nullptr };
+	size_t size { 0 };
+	SDL_GPUShaderFormat format { SDL_GPU_SHADERFORMAT_INVALID };
+	const char *entrypoint { nullptr };
+};
 
+// load the shader binary matching the backend's format
+// on success, code must be freed with SDL_free
+static ShaderCode loadShaderCode(SDL_GPUDevice *gpu, const std::string &filename) {
+	ShaderCode result;
 	SDL_GPUShaderFormat valid_formats = SDL_GetGPUShaderFormats(gpu);
-	SDL_GPUShaderFormat format = SDL_GPU_SHADERFORMAT_INVALID;
-	std::string entrypoint;
 	std::string shader_bin;
 	std::string file_extension;
 
 	if (valid_formats & SDL_GPU_SHADERFORMAT_SPIRV) {
-		format = SDL_GPU_SHADERFORMAT_SPIRV;
+		result.format = SDL_GPU_SHADERFORMAT_SPIRV;
 		shader_bin = "shaders/bin/SPIRV/";
 		file_extension = ".spv";
-		entrypoint = "main";
+		result.entrypoint = "main";
 	} else if (valid_formats & SDL_GPU_SHADERFORMAT_MSL) {
-		format = SDL_GPU_SHADERFORMAT_MSL;
+		result.format = SDL_GPU_SHADERFORMAT_MSL;
 		shader_bin = "shaders/bin/MSL/";
 		file_extension = ".msl";
-		entrypoint = "main0";
+		result.entrypoint = "main0";
 	} else if (valid_formats & SDL_GPU_SHADERFORMAT_DXIL) {
-		format = SDL_GPU_SHADERFORMAT_DXIL;
+		result.format = SDL_GPU_SHADERFORMAT_DXIL;
 		shader_bin = "shaders/bin/DXIL/";
 		file_extension = ".dxil";
-		entrypoint = "main";
+		result.entrypoint = "main";
 	} else {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Backend shader format is not supported");
-		return nullptr;
+		return result;
 	}
 
 	const std::string full_path { SDL_GetBasePath() + shader_bin + filename + file_extension };
 
-	size_t codeSize;
-	void* code = SDL_LoadFile(full_path.data(), &codeSize);
-	if (code == NULL) {
+	result.code = SDL_LoadFile(full_path.data(), &result.size);
+	if (result.code == NULL) {
 		SDL_Log("Failed to load shader from disk! %s", full_path.data());
+	}
+	return result;
+}
+
+// load a shader
+SDL_GPUShader* createShader(SDL_GPUDevice *gpu, GPUResource<SHADER> *shader, const std::string &filename, const Uint32 &num_samplers, const Uint32 &num_storage_textures, const Uint32 &num_storage_buffers, const Uint32 &num_uniform_buffers) {
+	// Auto-detect the shader stage from the file name for convenience
+	SDL_GPUShaderStage stage;
+	if (filename.contains(".vert")) {
+		stage = SDL_GPU_SHADERSTAGE_VERTEX;
+	} else if (filename.contains(".frag")) {
+		stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
+	} else {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid shader stage!");
 		return nullptr;
 	}
 
+	const ShaderCode code { loadShaderCode(gpu, filename) };
+	if (!code.code) { return nullptr; }
+
 	shader->info = {
-		.code_size = codeSize,
-		.code = static_cast<Uint8*>(code),
-		.entrypoint = entrypoint.data(),
-		.format = format,
+		.code_size = code.size,
+		.code = static_cast<Uint8*>(code.code),
+		.entrypoint = code.entrypoint,
+		.format = code.format,
 		.stage = stage,
 		.num_samplers = num_samplers,
 		.num_storage_textures = num_storage_textures,
@@ -61,7 +166,57 @@ SDL_GPUShader* createShader(SDL_GPUDevice *gpu, GPUResource<SHADER> *shader, con
 		.num_uniform_buffers = num_uniform_buffers,
 	};
 	shader->create(gpu);
-	SDL_free(code);
+	SDL_free(code.code);
 	return shader->get();
 }
 
+// load a compute shader & create its pipeline
+SDL_GPUComputePipeline* createComputePipeline(SDL_GPUDevice *gpu, GPUResource<COMPUTE_PIPELINE> *pipeline, const std::string &filename, const Uint32 &num_readonly_storage_buffers, const Uint32 &num_readwrite_storage_buffers, const Uint32 &num_uniform_buffers, const Uint32 &threadcount_x) {
+	if (!filename.contains(".comp")) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid shader stage!");
+		return nullptr;
+	}
+
+	const ShaderCode code { loadShaderCode(gpu, filename) };
+	if (!code.code) { return nullptr; }
+
+	pipeline->info = {
+		.code_size = code.size,
+		.code = static_cast<Uint8*>(code.code),
+		.entrypoint = code.entrypoint,
+		.format = code.format,
+		.num_readonly_storage_buffers = num_readonly_storage_buffers,
+		.num_readwrite_storage_buffers = num_readwrite_storage_buffers,
+		.num_uniform_buffers = num_uniform_buffers,
+		.threadcount_x = threadcount_x,
+		.threadcount_y = 1,
+		.threadcount_z = 1,
+	};
+	pipeline->create(gpu);
+	SDL_free(code.code);
+	return pipeline->get();
+}
+
+bool GPUGrowableBuffer::reserve(SDL_GPUDevice *gpu, SDL_GPUCopyPass *copypass, const Uint32 &bytes) {
+	const Uint32 old_size { size() };
+	if (bytes <= old_size) { return true; }
+	GPUResource<BUFFER> &old_buffer { m_buffers[m_current] };
+	GPUResource<BUFFER> &new_buffer { m_buffers[1 - m_current] };
+	new_buffer.info = { usage, SDL_max(bytes, old_size * 2) };
+	if (!new_buffer.create(gpu)) { return false; }
+	if (old_buffer.get()) {
+		if (copypass) {
+			const SDL_GPUBufferLocation source { old_buffer.get(), 0 };
+			const SDL_GPUBufferLocation destination { new_buffer.get(), 0 };
+			SDL_CopyGPUBufferToBuffer(copypass, &source, &destination, old_size, false);
+		}
+		// destruction is deferred until the copy is done
+		old_buffer.release();
+	}
+	m_current = 1 - m_current;
+	return true;
+}
+
+void GPUGrowableBuffer::release() {
+	if (get()) { m_buffers[m_current].release(); }
+}
@@ -0,0 +1,239 @@
+#include "Jobs.hpp"
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_log.h>
+
+#include <array>
+#include <utility>
+
+// deque owned by the calling thread, threads outside the pool use the first one
+static thread_local const JobSystem *t_owner { nullptr };
+static thread_local Uint32 t_queue { 0 };
+
+void JobSystem::init(Uint32 num_workers) {
+	if (num_workers == 0) {
+		const int cores { SDL_GetNumLogicalCPUCores() };
+		num_workers = cores > 1 ? static_cast<Uint32>(cores - 1) : 1;
+	}
+	m_running = true;
+	for (Uint32 i = 0; i <= num_workers; ++i) {
+		m_queues.emplace_back(std::make_unique<Queue>());
+		m_queues.back()->ring.resize(256);
+	}
+	for (Uint32 i = 1; i <= num_workers; ++i) {
+		m_threads.emplace_back(&JobSystem::worker, this, i);
+	}
+	m_background_thread = std::thread { &JobSystem::backgroundWorker, this };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Started job system with %u workers", num_workers);
+}
+
+void JobSystem::quit() {
+	{
+		std::lock_guard lock { m_sleep_mutex };
+		m_running = false;
+	}
+	m_wake.notify_all();
+	// the background thread checks m_running under its own mutex
+	{ std::lock_guard lock { m_background_mutex }; }
+	m_background_wake.notify_all();
+	for (std::thread &thread : m_threads) {
+		thread.join();
+	}
+	if (m_background_thread.joinable()) { m_background_thread.join(); }
+	m_threads.clear();
+	m_queues.clear();
+}
+
+JobHandle JobSystem::submit(JobTask task, std::span<const JobHandle> dependencies) {
+	JobHandle job { std::allocate_shared<Job>(std::pmr::polymorphic_allocator<Job> { &m_job_pool }) };
+	job->task = std::move(task);
+	job->pending += static_cast<Uint32>(dependencies.size());
+	for (const JobHandle &dependency : dependencies) {
+		std::unique_lock lock { dependency->mutex };
+		if (dependency->done) {
+			lock.unlock();
+			--job->pending;
+		} else if (dependency->num_continuations < Job::inline_continuations) {
+			dependency->continuations[dependency->num_continuations++] = job;
+		} else {
+			dependency->overflow.push_back(job);
+		}
+	}
+	// drop the submission reference, dependencies may have finished already
+	if (--job->pending == 0) {
+		schedule(job);
+	}
+	return job;
+}
+
+JobHandle JobSystem::submitBackground(JobTask task) {
+	JobHandle job { std::allocate_shared<Job>(std::pmr::polymorphic_allocator<Job> { &m_job_pool }) };
+	job->task = std::move(task);
+	job->pending = 0;
+	// without a background thread, run in place
+	if (!m_background_thread.joinable()) {
+		execute(job);
+		return job;
+	}
+	{
+		std::lock_guard lock { m_background_mutex };
+		m_background.push_back(job);
+	}
+	m_background_wake.notify_one();
+	return job;
+}
+
+void JobSystem::wait(const JobHandle &job) {
+	while (!job->done) {
+		if (JobHandle other { next() }; other) {
+			execute(other);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::parallelFor(Uint32 count, Uint32 grain, void (*body)(const void *context, Uint32 begin, Uint32 end), const void *context) {
+	if (count == 0) { return; }
+	grain = grain ? grain : 1;
+	// not worth scheduling, or there is nobody to share with
+	if (count <= grain || m_queues.size() < 2) {
+		body(context, 0, count);
+		return;
+	}
+	// handles live on the stack unless there are a lot of chunks
+	std::array<std::byte, 1024> scratch;
+	std::pmr::monotonic_buffer_resource chunk_resource { scratch.data(), scratch.size() };
+	std::pmr::vector<JobHandle> chunks { &chunk_resource };
+	chunks.reserve((count + grain - 1) / grain);
+	for (Uint32 begin = grain; begin < count; begin += grain) {
+		const Uint32 end { std::min(begin + grain, count) };
+		chunks.push_back(submit([body, context, begin, end] { body(context, begin, end); }));
+	}
+	// the caller takes the first chunk instead of idling
+	body(context, 0, grain);
+	for (const JobHandle &chunk : chunks) {
+		wait(chunk);
+	}
+}
+
+void JobSystem::worker(Uint32 index) {
+	t_owner = this;
+	t_queue = index;
+	while (true) {
+		if (JobHandle job { next() }; job) {
+			execute(job);
+			continue;
+		}
+		std::unique_lock lock { m_sleep_mutex };
+		m_wake.wait(lock, [this] { return m_queued > 0 || !m_running; });
+		if (!m_running && m_queued == 0) { return; }
+	}
+}
+
+void JobSystem::backgroundWorker() {
+	while (true) {
+		JobHandle job;
+		{
+			std::unique_lock lock { m_background_mutex };
+			m_background_wake.wait(lock, [this] { return !m_background.empty() || !m_running; });
+			// drain what was submitted before quit so nobody waits on a job that never runs
+			if (m_background.empty()) { return; }
+			job = std::move(m_background.front());
+			m_background.pop_front();
+		}
+		execute(job);
+	}
+}
+
+void JobSystem::schedule(JobHandle job) {
+	// without workers, run in place
+	if (m_queues.empty()) {
+		execute(job);
+		return;
+	}
+	Queue &queue { *m_queues.at(t_owner == this ? t_queue : 0) };
+	{
+		// counted before it can be popped, next() decrements as soon as it pops
+		std::lock_guard lock { queue.mutex };
+		++m_queued;
+		queue.pushBack(std::move(job));
+	}
+	// a worker checks m_queued under the sleep mutex, taking it here keeps the wakeup from being lost
+	{ std::lock_guard lock { m_sleep_mutex }; }
+	m_wake.notify_one();
+}
+
+JobHandle JobSystem::next() {
+	if (m_queues.empty()) { return nullptr; }
+	const Uint32 own { t_owner == this ? t_queue : 0 };
+	// newest job of our own deque is the most likely to be in cache
+	{
+		Queue &queue { *m_queues.at(own) };
+		std::lock_guard lock { queue.mutex };
+		if (queue.count) {
+			--m_queued;
+			return queue.popBack();
+		}
+	}
+	// steal the oldest job of another deque
+	const Uint32 num_queues { static_cast<Uint32>(m_queues.size()) };
+	for (Uint32 i = 1; i < num_queues; ++i) {
+		Queue &queue { *m_queues.at((own + i) % num_queues) };
+		std::lock_guard lock { queue.mutex };
+		if (queue.count) {
+			--m_queued;
+			return queue.popFront();
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::execute(const JobHandle &job) {
+	job->task();
+	job->task.reset();
+	std::array<JobHandle, Job::inline_continuations> continuations;
+	Uint32 num_continuations;
+	std::vector<JobHandle> overflow;
+	{
+		std::lock_guard lock { job->mutex };
+		job->done = true;
+		continuations.swap(job->continuations);
+		num_continuations = std::exchange(job->num_continuations, 0);
+		overflow.swap(job->overflow);
+	}
+	auto release = [this](JobHandle &continuation) {
+		if (--continuation->pending == 0) {
+			schedule(std::move(continuation));
+		}
+	};
+	for (Uint32 i = 0; i < num_continuations; ++i) {
+		release(continuations[i]);
+	}
+	for (JobHandle &continuation : overflow) {
+		release(continuation);
+	}
+}
+
+void JobSystem::Queue::pushBack(JobHandle job) {
+	if (count == ring.size()) {
+		// unroll into a larger ring, oldest job first
+		std::vector<JobHandle> grown(SDL_max(ring.size() * 2, std::size_t { 16 }));
+		for (Uint32 i = 0; i < count; ++i) {
+			grown[i] = std::move(ring[(head + i) % ring.size()]);
+		}
+		ring.swap(grown);
+		head = 0;
+	}
+	ring[(head + count++) % ring.size()] = std::move(job);
+}
+
+JobHandle JobSystem::Queue::popBack() {
+	return std::move(ring[(head + --count) % ring.size()]);
+}
+
+JobHandle JobSystem::Queue::popFront() {
+	JobHandle job { std::move(ring[head]) };
+	head = (head + 1) % ring.size();
+	--count;
+	return job;
+}
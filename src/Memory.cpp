@@ -0,0 +1,85 @@
+#include "Memory.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(SDL_PLATFORM_WINDOWS)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static std::atomic<Uint64> s_allocations { 0 };
+
+Uint64 heapAllocations() {
+	return s_allocations.load(std::memory_order_relaxed);
+}
+
+Uint64 peakResidentBytes() {
+#if defined(SDL_PLATFORM_WINDOWS)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#if defined(SDL_PLATFORM_APPLE)
+	return static_cast<Uint64>(usage.ru_maxrss); // bytes
+#else
+	return static_cast<Uint64>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+// every other form of operator new & delete forwards to these
+void* operator new(std::size_t bytes) {
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr { std::malloc(bytes ? bytes : 1) }; ptr) { return ptr; }
+	throw std::bad_alloc { };
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment) {
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr { SDL_aligned_alloc(static_cast<std::size_t>(alignment), bytes ? bytes : 1) }; ptr) { return ptr; }
+	throw std::bad_alloc { };
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+	SDL_aligned_free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+	SDL_aligned_free(ptr);
+}
+
+void FrameArena::reset() {
+	// grow so the last frame would have fit, spilling should only happen while the workload ramps up
+	if (m_spilled) {
+		m_block.resize((m_used + m_spilled) * 2);
+		m_spill.release();
+		m_spilled = 0;
+	}
+	m_used = 0;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+	const std::size_t address { reinterpret_cast<std::size_t>(m_block.data()) + m_used };
+	const std::size_t padding { (alignment - address % alignment) % alignment };
+	if (m_used + padding + bytes <= m_block.size()) {
+		void *ptr { m_block.data() + m_used + padding };
+		m_used += padding + bytes;
+		return ptr;
+	}
+	m_spilled += bytes + alignment;
+	return m_spill.allocate(bytes, alignment);
+}
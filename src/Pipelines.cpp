@@ -1,12 +1,73 @@
 #include "Pipelines.hpp"
+#include "Scene.hpp"
 #include "SDL3/SDL_gpu.h"
 #include "glm/ext/matrix_clip_space.hpp"
+#include "glm/matrix.hpp"
 SDL_AppResult BlinnPhongPipeline::init(SDL_GPUDevice *gpu) {
-	if (!createShader(gpu, &m_v_shader, "PositionTransform.vert", 0, 0, 0, 1))
+	if (!createShader(gpu, &m_v_shader, "PositionInstanced.vert", 0, 0, 1, 1))
 		return SDL_APP_FAILURE;
-	if (!createShader(gpu, &m_f_shader, "SolidColorDepth.frag", 0, 0, 0, 1))
+	if (!createShader(gpu, &m_f_shader, "BaseColorDepth.frag", 1, 0, 0, 1))
 		return SDL_APP_FAILURE;
-	m_pipeline.info = {
+	m_gpu = gpu;
+	m_sampler.info = {
+		.min_filter = SDL_GPU_FILTER_LINEAR,
+		.mag_filter = SDL_GPU_FILTER_LINEAR,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
+		.max_lod = 1000,
+	};
+	if (!m_sampler.create(gpu))
+		return SDL_APP_FAILURE;
+	if (!createWhiteTexture())
+		return SDL_APP_FAILURE;
+	// the float layout is the most common, don't wait for the first frame to create it
+	if (!pipelineFor(VertexLayout { }))
+		return SDL_APP_FAILURE;
+	return SDL_APP_CONTINUE;
+}
+bool BlinnPhongPipeline::createWhiteTexture() {
+	m_white.info = {
+		.type = SDL_GPU_TEXTURETYPE_2D,
+		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = 1,
+		.height = 1,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+	};
+	if (!m_white.create(m_gpu)) { return false; }
+	GPUResource<TRANSFER_BUFFER> transfer_buf;
+	transfer_buf.info = {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = sizeof(Uint32),
+	};
+	if (!transfer_buf.create(m_gpu)) { return false; }
+	Uint32 *pixel { static_cast<Uint32*>(SDL_MapGPUTransferBuffer(m_gpu, transfer_buf.get(), false)) };
+	*pixel = 0xFFFFFFFF;
+	SDL_UnmapGPUTransferBuffer(m_gpu, transfer_buf.get());
+	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(m_gpu) };
+	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
+	const SDL_GPUTextureTransferInfo source { .transfer_buffer = transfer_buf.get() };
+	const SDL_GPUTextureRegion destination { .texture = m_white.get(), .w = 1, .h = 1, .d = 1 };
+	SDL_UploadToGPUTexture(copypass, &source, &destination, false);
+	SDL_EndGPUCopyPass(copypass);
+	SDL_SubmitGPUCommandBuffer(cmdbuf);
+	transfer_buf.release();
+	return true;
+}
+SDL_GPUGraphicsPipeline* BlinnPhongPipeline::pipelineFor(const VertexLayout &layout) {
+	for (LayoutPipeline &cached : m_pipelines) {
+		if (cached.layout == layout) { return cached.pipeline.get(); }
+	}
+	buffer_desc[0].pitch = layout.position_pitch;
+	buffer_desc[1].pitch = layout.normal_pitch;
+	vert_attribs[0].format = layout.position;
+	vert_attribs[1].format = layout.normal;
+	LayoutPipeline &created { m_pipelines.emplace_back() };
+	created.layout = layout;
+	created.pipeline.info = {
 		.vertex_shader = m_v_shader.get(),
 		.fragment_shader = m_f_shader.get(),
 		.vertex_input_state = {
@@ -35,15 +96,23 @@ SDL_AppResult BlinnPhongPipeline::init(SDL_GPUDevice *gpu) {
 			.has_depth_stencil_target = true,
 		},
 	};
-	if (!m_pipeline.create(gpu)) { return SDL_APP_FAILURE; }
-	m_v_shader.release();
-	m_f_shader.release();
-	return SDL_APP_CONTINUE;
+	if (!created.pipeline.create(m_gpu)) {
+		m_pipelines.pop_back();
+		return nullptr;
+	}
+	return created.pipeline.get();
 }
 void BlinnPhongPipeline::quit() {
-	m_pipeline.release(); 
+	for (LayoutPipeline &cached : m_pipelines) {
+		cached.pipeline.release();
+	}
+	m_pipelines.clear();
+	m_v_shader.release();
+	m_f_shader.release();
+	m_sampler.release();
+	m_white.release();
 }
-void BlinnPhongPipeline::render(SDL_GPUCommandBuffer *cmdbuf, const GPUResource<TEXTURE> &color, const GPUResource<TEXTURE> &depth, const Camera &camera, const std::vector<Mesh> &TRS_data, const GPUResource<BUFFER> &indices, const GPUResource<BUFFER> &verts, const GPUResource<BUFFER> &norms) {
+void BlinnPhongPipeline::render(SDL_GPUCommandBuffer *cmdbuf, const GPUResource<TEXTURE> &color, const GPUResource<TEXTURE> &depth, const SDL_GPUViewport &viewport, const Camera &camera, const Scene &scene) {
 	const SDL_GPUColorTargetInfo color_target_info {
 		.texture = color.get(),
 		.clear_color = {0, 0, 0, 0},
@@ -60,43 +129,153 @@ void BlinnPhongPipeline::render(SDL_GPUCommandBuffer *cmdbuf, const GPUResource<
 		.cycle = true,
 		.clear_stencil = 0,
 	};
-	const SDL_GPUBufferBinding i_buf_binding {
-		.buffer = indices.get(),
-		.offset = 0
-	};
-	const SDL_GPUBufferBinding vert_buf_bindings[2] { {
-			.buffer = verts.get(),
-			.offset = 0
-		}, {
-			.buffer = norms.get(),
-			.offset = 0
-	} };
-	const FragmentUniforms frag_uniforms { 
-		camera.near_far,
-		camera.pos
-	};
-	SDL_PushGPUFragmentUniformData(cmdbuf, 0, &frag_uniforms, sizeof(frag_uniforms));
-	VertexUniforms vert_uniforms;
-	vert_uniforms.proj_view = camera.proj() * camera.view();
 	SDL_GPURenderPass *render_pass { SDL_BeginGPURenderPass(cmdbuf, &color_target_info, 1, &depth_stencil_target_info) };
-	SDL_BindGPUVertexBuffers(render_pass, 0, vert_buf_bindings, SDL_arraysize(vert_buf_bindings));
-	SDL_BindGPUIndexBuffer(render_pass, &i_buf_binding, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-	SDL_BindGPUGraphicsPipeline(render_pass, m_pipeline.get());
-	for (const Mesh &mesh : TRS_data) {
-		vert_uniforms.model = mesh.model_mat();
+	SDL_SetGPUViewport(render_pass, &viewport);
+	SDL_GPUBuffer *storage_buffers[1] { scene.instances() };
+	// commands are ordered by material within each pool, one draw call per material of each pool
+	for (const GeometryPool &pool : scene.pools()) {
+		if (!pool.drawCount() || !pool.visible) { continue; }
+		SDL_GPUGraphicsPipeline *pipeline { pipelineFor(pool.layout) };
+		if (!pipeline) { continue; }
+		const SDL_GPUBufferBinding i_buf_binding {
+			.buffer = pool.indices.get(),
+			.offset = 0
+		};
+		const SDL_GPUBufferBinding vert_buf_bindings[4] { {
+				.buffer = pool.verts.get(),
+				.offset = 0
+			}, {
+				.buffer = pool.norms.get(),
+				.offset = 0
+			}, {
+				.buffer = scene.instanceIds(),
+				.offset = 0
+			}, {
+				.buffer = pool.uvs.get(),
+				.offset = 0
+		} };
+		const VertexUniforms vert_uniforms { camera.proj() * camera.view(), pool.layout.position_scale };
 		SDL_PushGPUVertexUniformData(cmdbuf, 0, &vert_uniforms, sizeof(vert_uniforms));
-		SDL_DrawGPUIndexedPrimitives(render_pass, mesh.num_indices, 1, mesh.first_index, 0, 0);
+		SDL_BindGPUGraphicsPipeline(render_pass, pipeline);
+		SDL_BindGPUVertexBuffers(render_pass, 0, vert_buf_bindings, SDL_arraysize(vert_buf_bindings));
+		SDL_BindGPUIndexBuffer(render_pass, &i_buf_binding, pool.layout.index_size);
+		SDL_BindGPUVertexStorageBuffers(render_pass, 0, storage_buffers, SDL_arraysize(storage_buffers));
+		for (const PoolMaterialRange &range : pool.material_ranges) {
+			const Material &material { range.material };
+			const StreamedTexture *texture { material.texture != Material::no_texture ? scene.texture(material.texture) : nullptr };
+			const SDL_GPUTextureSamplerBinding sampler_binding {
+				.texture = texture ? texture->texture.get() : m_white.get(),
+				.sampler = m_sampler.get(),
+			};
+			const FragmentUniforms frag_uniforms {
+				.base_color = material.base_color,
+				.view_pos = camera.pos,
+				.min_lod = texture ? static_cast<float>(texture->resident_level) : 0.0f,
+				.near_far = camera.near_far,
+				.has_texture = texture != nullptr,
+			};
+			SDL_BindGPUFragmentSamplers(render_pass, 0, &sampler_binding, 1);
+			SDL_PushGPUFragmentUniformData(cmdbuf, 0, &frag_uniforms, sizeof(frag_uniforms));
+			SDL_DrawGPUIndexedPrimitivesIndirect(render_pass, pool.commands.get(),
+					range.first_command * static_cast<Uint32>(sizeof(SDL_GPUIndexedIndirectDrawCommand)), range.num_commands);
+		}
 	}
 	SDL_EndGPURenderPass(render_pass);
 }
 
-SDL_AppResult OutlinePipeline::init(SDL_Window *window, SDL_GPUDevice *gpu) {
+SDL_AppResult CullPipeline::init(SDL_GPUDevice *gpu) {
+	m_gpu = gpu;
+	if (!createComputePipeline(gpu, &m_pipeline, "Cull.comp", 4, 2, 1, workgroup_size))
+		return SDL_APP_FAILURE;
+	m_stats.info = {
+		.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+		.size = sizeof(CullStats),
+	};
+	if (!m_stats.create(gpu)) { return SDL_APP_FAILURE; }
+	// zeroed once & never mapped again, every frame copies it over the counters
+	m_zero.info = {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = sizeof(CullStats),
+	};
+	if (!m_zero.create(gpu)) { return SDL_APP_FAILURE; }
+	void *zero { SDL_MapGPUTransferBuffer(gpu, m_zero.get(), false) };
+	SDL_memset(zero, 0, sizeof(CullStats));
+	SDL_UnmapGPUTransferBuffer(gpu, m_zero.get());
+	for (GPUResource<TRANSFER_BUFFER> &readback : m_readback) {
+		readback.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+			.size = sizeof(CullStats),
+		};
+		if (!readback.create(gpu)) { return SDL_APP_FAILURE; }
+	}
+	return SDL_APP_CONTINUE;
+}
+void CullPipeline::quit() {
+	for (GPUResource<TRANSFER_BUFFER> &readback : m_readback) {
+		readback.release();
+	}
+	m_zero.release();
+	m_stats.release();
+	m_pipeline.release();
+}
+void CullPipeline::dispatch(SDL_GPUCommandBuffer *cmdbuf, const Camera &camera, const Scene &scene, const Uint32 &slot) {
+	SDL_assert(slot < readback_slots);
+	const std::array<glm::vec4, 6> planes { camera.frustum() };
+	const SDL_GPUTransferBufferLocation zero { m_zero.get(), 0 };
+	const SDL_GPUBufferRegion counters { m_stats.get(), 0, sizeof(CullStats) };
+	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
+	SDL_UploadToGPUBuffer(copypass, &zero, &counters, false);
+	SDL_EndGPUCopyPass(copypass);
+	for (const GeometryPool &pool : scene.pools()) {
+		const Uint32 draw_count { pool.drawCount() };
+		// objects in view are uploaded by Scene::upload after Scene::cull, there are none before the first cull
+		if (!scene.visibility()) { break; }
+		// pools out of view aren't drawn, their commands can be stale
+		if (!draw_count || !pool.visible) { continue; }
+		// every command is rewritten each frame, cycle so the previous frame's commands stay intact,
+		// the counters add up over every pool of the frame
+		const SDL_GPUStorageBufferReadWriteBinding rw_bindings[2] { {
+			.buffer = pool.commands.get(),
+			.cycle = true,
+		}, {
+			.buffer = m_stats.get(),
+			.cycle = false,
+		} };
+		SDL_GPUBuffer *storage_buffers[4] { scene.instances(), pool.draws.get(), pool.order.get(), scene.visibility() };
+		const ComputeUniforms uniforms { planes, camera.pos, draw_count };
+		SDL_GPUComputePass *compute_pass { SDL_BeginGPUComputePass(cmdbuf, nullptr, 0, rw_bindings, SDL_arraysize(rw_bindings)) };
+		SDL_BindGPUComputePipeline(compute_pass, m_pipeline.get());
+		SDL_BindGPUComputeStorageBuffers(compute_pass, 0, storage_buffers, SDL_arraysize(storage_buffers));
+		SDL_PushGPUComputeUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+		SDL_DispatchGPUCompute(compute_pass, (draw_count + workgroup_size - 1) / workgroup_size, 1, 1);
+		SDL_EndGPUComputePass(compute_pass);
+	}
+	// read back once the frame's fence is signaled, the slot isn't touched before then
+	const SDL_GPUTransferBufferLocation readback { m_readback[slot].get(), 0 };
+	copypass = SDL_BeginGPUCopyPass(cmdbuf);
+	SDL_DownloadFromGPUBuffer(copypass, &counters, &readback);
+	SDL_EndGPUCopyPass(copypass);
+	m_pending[slot] = true;
+}
+std::optional<CullPipeline::CullStats> CullPipeline::stats(const Uint32 &slot) {
+	SDL_assert(slot < readback_slots);
+	if (!m_pending[slot]) { return std::nullopt; }
+	m_pending[slot] = false;
+	CullStats result;
+	const void *mapped { SDL_MapGPUTransferBuffer(m_gpu, m_readback[slot].get(), false) };
+	if (!mapped) { return std::nullopt; }
+	SDL_memcpy(&result, mapped, sizeof(result));
+	SDL_UnmapGPUTransferBuffer(m_gpu, m_readback[slot].get());
+	return result;
+}
+
+SDL_AppResult OutlinePipeline::init(SDL_GPUDevice *gpu, const SDL_GPUTextureFormat &format) {
 	if (!createShader(gpu, &m_v_shader, "Window.vert", 0, 0, 0, 0))
 		return SDL_APP_FAILURE;
 	if (!createShader(gpu, &m_f_shader, "DepthOutline.frag", 2, 0, 0, 1))
 		return SDL_APP_FAILURE;
 	m_color_target = {
-		.format = SDL_GetGPUSwapchainTextureFormat(gpu, window),
+		.format = format,
 		.blend_state = {
 			.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
 			.dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
@@ -119,22 +298,33 @@ SDL_AppResult OutlinePipeline::init(SDL_Window *window, SDL_GPUDevice *gpu) {
 	if (!m_pipeline.create(gpu)) { return SDL_APP_FAILURE; }
 	m_v_shader.release();
 	m_f_shader.release();
+	// depth taps past the rendered area must not wrap around to the stale opposite edge
 	m_sampler.info = {
 		.min_filter = SDL_GPU_FILTER_NEAREST,
 		.mag_filter = SDL_GPU_FILTER_NEAREST,
 		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
-		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
-		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
-		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_REPEAT,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
 	};
 	if (!m_sampler.create(gpu)) { return SDL_APP_FAILURE; }
+	m_linear_sampler.info = {
+		.min_filter = SDL_GPU_FILTER_LINEAR,
+		.mag_filter = SDL_GPU_FILTER_LINEAR,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+	};
+	if (!m_linear_sampler.create(gpu)) { return SDL_APP_FAILURE; }
 	return SDL_APP_CONTINUE;
 }
 void OutlinePipeline::quit() {
 	m_pipeline.release();
 	m_sampler.release();
+	m_linear_sampler.release();
 }
-void OutlinePipeline::render(SDL_GPUCommandBuffer* cmdbuf, SDL_GPUTexture *dest, GPUResource<TEXTURE> &color, GPUResource<TEXTURE> &depth) {
+void OutlinePipeline::render(SDL_GPUCommandBuffer* cmdbuf, SDL_GPUTexture *dest, GPUResource<TEXTURE> &color, GPUResource<TEXTURE> &depth, const glm::vec2 &uv_scale) {
 	SDL_GPUColorTargetInfo swapchain_target_info {
 		.texture = dest,
 		.clear_color = {0.2f, 0.5f, 0.4f, 1.0f},
@@ -144,36 +334,39 @@ void OutlinePipeline::render(SDL_GPUCommandBuffer* cmdbuf, SDL_GPUTexture *dest,
 	SDL_GPURenderPass *render_pass = SDL_BeginGPURenderPass(cmdbuf, &swapchain_target_info, 1, nullptr);
 	SDL_BindGPUGraphicsPipeline(render_pass, m_pipeline.get());
 	SDL_GPUTextureSamplerBinding sampler_bindings[] {
-		{ .texture = color.get(), .sampler = m_sampler.get() },
+		{ .texture = color.get(), .sampler = m_linear_sampler.get() },
 		{ .texture = depth.get(), .sampler = m_sampler.get() },
 	};
 	SDL_BindGPUFragmentSamplers(render_pass, 0, sampler_bindings, 2);
+	const FragmentUniforms frag_uniforms { uv_scale };
+	SDL_PushGPUFragmentUniformData(cmdbuf, 0, &frag_uniforms, sizeof(frag_uniforms));
 	SDL_DrawGPUPrimitives(render_pass, 6, 1, 0, 0);
 	SDL_EndGPURenderPass(render_pass);
 }
 
 // Mesh methods
 glm::mat4x4 Mesh::model_mat() const {
-	return { glm::scale(glm::translate(glm::mat4(1), pos), scale) * glm::mat4_cast(rot) };
+	return transform;
 }
 
 // Camera methods
 void Camera::iterate() {
 	glm::vec3 acc = {0, 0, 0};
-	if (m_keys.contains(SDL_SCANCODE_W) && m_keys.at(SDL_SCANCODE_W))
+	if (m_keys[SDL_SCANCODE_W])
 		acc += speed * forward();
-	if (m_keys.contains(SDL_SCANCODE_A) && m_keys.at(SDL_SCANCODE_A))
+	if (m_keys[SDL_SCANCODE_A])
 		acc += speed * -right();
-	if (m_keys.contains(SDL_SCANCODE_S) && m_keys.at(SDL_SCANCODE_S))
+	if (m_keys[SDL_SCANCODE_S])
 		acc += speed * -forward();
-	if (m_keys.contains(SDL_SCANCODE_D) && m_keys.at(SDL_SCANCODE_D))
+	if (m_keys[SDL_SCANCODE_D])
 		acc += speed * right();
-	if (m_keys.contains(SDL_SCANCODE_E) && m_keys.at(SDL_SCANCODE_E))
+	if (m_keys[SDL_SCANCODE_E])
 		acc += speed * up();
-	if (m_keys.contains(SDL_SCANCODE_Q) && m_keys.at(SDL_SCANCODE_Q))
+	if (m_keys[SDL_SCANCODE_Q])
 		acc += speed * -up();
 	vel += acc;
-	pos += vel;
+	m_prev_pos = m_sim_pos;
+	m_sim_pos += vel;
 	const glm::vec3 drag { vel * -0.1f };
 	vel += drag;
 	// when velocity is close to zero, make it zero
@@ -190,17 +383,21 @@ void Camera::iterate() {
 	if (set_zero_axis[2])
 		vel.z = 0;
 }
+void Camera::interpolate(const float &alpha) {
+	pos = glm::mix(m_prev_pos, m_sim_pos, alpha);
+}
+void Camera::place(const glm::vec3 &t_pos, const glm::quat &t_rot) {
+	pos = m_prev_pos = m_sim_pos = t_pos;
+	rot = t_rot;
+	vel = { 0, 0, 0 };
+}
 void Camera::event(SDL_Event *e) {
 	switch(e->type) {
 	case SDL_EVENT_KEY_DOWN:
-		if (!m_keys.contains(e->key.scancode)) {
-			m_keys.insert({e->key.scancode, true});
-		} else {
-			m_keys.at(e->key.scancode) = true;
-		}
+		m_keys[e->key.scancode] = true;
 		break;
 	case SDL_EVENT_KEY_UP: 
-		m_keys.at(e->key.scancode) = false;
+		m_keys[e->key.scancode] = false;
 		break;
 	case SDL_EVENT_MOUSE_MOTION: {
 		const float sensitivity { 0.001f };
@@ -221,6 +418,13 @@ glm::mat4 Camera::view() const {
 glm::mat4 Camera::proj() const {
 	return glm::perspective(SDL_PI_F * 0.25f, dimensions.x / dimensions.y, near_far.x, near_far.y);
 }
+glm::vec3 Camera::ray(const glm::vec2 &ndc) const {
+	// unproject two points on the line through ndc, z = 0 & 1 are inside clip space with either depth convention
+	const glm::mat4 inv_proj_view { glm::inverse(proj() * view()) };
+	glm::vec4 near { inv_proj_view * glm::vec4(ndc, 0, 1) };
+	glm::vec4 far { inv_proj_view * glm::vec4(ndc, 1, 1) };
+	return glm::normalize(glm::vec3(far) / far.w - glm::vec3(near) / near.w);
+}
 glm::vec3 Camera::forward() const {
 	return glm::conjugate(rot) * glm::vec3(0.0f, 0.0f, -1.0f);
 }
@@ -230,3 +434,19 @@ glm::vec3 Camera::up() const {
 glm::vec3 Camera::right() const {
 	return glm::conjugate(rot) * glm::vec3(1.0f, 0.0f, 0.0f);
 }
+std::array<glm::vec4, 6> Camera::frustum() const {
+	// Gribb-Hartmann: combine the rows of the clip matrix
+	const glm::mat4 clip { glm::transpose(proj() * view()) };
+	std::array<glm::vec4, 6> planes {
+		clip[3] + clip[0], // left
+		clip[3] - clip[0], // right
+		clip[3] + clip[1], // bottom
+		clip[3] - clip[1], // top
+		clip[3] + clip[2], // near
+		clip[3] - clip[2], // far
+	};
+	for (glm::vec4 &plane : planes) {
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return planes;
+}
@@ -0,0 +1,100 @@
+#include "Profiling.hpp"
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+#include <cmath>
+
+void ResolutionGovernor::update(const float &frame_ms, const float &gpu_wait_ms) {
+	m_frame_ms += (frame_ms - m_frame_ms) * 0.1f;
+	m_gpu_wait_ms += (gpu_wait_ms - m_gpu_wait_ms) * 0.1f;
+	if (!m_enabled) { return; }
+	if (m_cooldown) {
+		--m_cooldown;
+		return;
+	}
+	const bool slow { m_frame_ms > target_ms * 1.05f };
+	const bool gpu_bound { m_gpu_wait_ms > 0.5f };
+	float scale { m_scale };
+	if (slow && gpu_bound) {
+		// cost follows the pixel count, which goes with the square of the scale
+		scale *= SDL_clamp(std::sqrt(target_ms / m_frame_ms), 0.8f, 0.98f);
+	} else if (!slow && (m_frame_ms < target_ms * 0.9f || !gpu_bound)) {
+		// step up slowly, overshooting costs a dropped frame
+		scale *= 1.02f;
+	}
+	scale = SDL_clamp(scale, min_scale, max_scale);
+	if (scale != m_scale) {
+		m_scale = scale;
+		m_cooldown = 30;
+	}
+}
+
+void ResolutionGovernor::setEnabled(const bool &enabled) {
+	m_enabled = enabled;
+	m_scale = max_scale;
+	m_cooldown = 0;
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Dynamic resolution %s", enabled ? "enabled" : "disabled");
+}
+
+void FrameStats::frame(const float &frame_ms, const float &gpu_wait_ms, const float &scale, const Uint32 &width, const Uint32 &height) {
+	const Uint64 now { SDL_GetTicksNS() };
+	const std::clock_t cpu { std::clock() };
+	if (!m_period_start) {
+		m_period_start = now;
+		m_period_cpu = cpu;
+	}
+	++m_frames;
+	m_frame_ms += frame_ms;
+	m_max_frame_ms = SDL_max(m_max_frame_ms, frame_ms);
+	m_gpu_wait_ms += gpu_wait_ms;
+	if (now - m_period_start < SDL_NS_PER_SECOND) { return; }
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Frame: %.2f ms avg, %.2f ms max (%u fps), gpu wait %.2f ms, render scale %.2f (%ux%u)",
+			m_frame_ms / m_frames, m_max_frame_ms, m_frames, m_gpu_wait_ms / m_frames, scale, width, height);
+	// cpu time is summed over every thread, 100% is one core (std::clock measures wall time on windows)
+	const double cpu_percent { 100.0 * (cpu - m_period_cpu) / CLOCKS_PER_SEC / ((now - m_period_start) / 1e9) };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Idle: %u of %u frames only composited, cpu %.1f%%", m_elided, m_frames, cpu_percent);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Heap: %u of %u frames allocated, %llu allocations, %llu max in one frame",
+			m_allocating_frames, m_frames, static_cast<unsigned long long>(m_allocations), static_cast<unsigned long long>(m_max_allocations));
+	if (m_culled_frames) {
+		const Uint64 total { m_submitted + m_frustum_culled + m_backface_culled };
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Triangles: %llu submitted, %llu frustum culled, %llu backface culled per frame (%.1f%% culled)",
+				static_cast<unsigned long long>(m_submitted / m_culled_frames), static_cast<unsigned long long>(m_frustum_culled / m_culled_frames),
+				static_cast<unsigned long long>(m_backface_culled / m_culled_frames), total ? 100.0 * (total - m_submitted) / total : 0.0);
+	}
+	if (m_captured || m_capture_dropped) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Capture: %.1f frames/s written, %u dropped",
+				m_captured / ((now - m_period_start) / 1e9), m_capture_dropped);
+	}
+	if (m_inputs) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Input to submit: %.2f ms avg, %.2f ms max",
+				m_latency_ms / m_inputs, m_max_latency_ms);
+	}
+	*this = FrameStats { };
+	m_period_start = now;
+	m_period_cpu = cpu;
+}
+
+void FrameStats::allocations(const Uint64 &count) {
+	if (!count) { return; }
+	++m_allocating_frames;
+	m_allocations += count;
+	m_max_allocations = SDL_max(m_max_allocations, count);
+}
+
+void FrameStats::triangles(const Uint64 &submitted, const Uint64 &frustum_culled, const Uint64 &backface_culled) {
+	++m_culled_frames;
+	m_submitted += submitted;
+	m_frustum_culled += frustum_culled;
+	m_backface_culled += backface_culled;
+}
+
+void FrameStats::captures(const Uint32 &written, const Uint32 &dropped) {
+	m_captured += written;
+	m_capture_dropped += dropped;
+}
+
+void FrameStats::latency(const float &latency_ms) {
+	++m_inputs;
+	m_latency_ms += latency_ms;
+	m_max_latency_ms = SDL_max(m_max_latency_ms, latency_ms);
+}
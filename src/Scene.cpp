@@ -0,0 +1,1543 @@
+#include "Scene.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <tuple>
+
+#include <SDL3/SDL_events.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_timer.h>
+
+#include <fastgltf/core.hpp>
+#include <fastgltf/tools.hpp>
+
+#include <meshoptimizer.h>
+#include <basisu_transcoder.h>
+
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+// bytes of a buffer, regardless of how fastgltf loaded it
+static const std::byte* bufferBytes(const fastgltf::Buffer &buffer) {
+	return std::visit([](const auto &source) -> const std::byte* {
+		if constexpr (requires { source.bytes.data(); }) {
+			return reinterpret_cast<const std::byte*>(source.bytes.data());
+		} else {
+			return nullptr;
+		}
+	}, buffer.data);
+}
+
+// read component i of an element as float, applying the accessor's normalization
+static float readComponent(const std::byte *element, const fastgltf::ComponentType &type, const bool &normalized, const Uint32 &i) {
+	switch(type) {
+	case fastgltf::ComponentType::Byte: {
+		Sint8 value;
+		SDL_memcpy(&value, element + i * sizeof(value), sizeof(value));
+		return normalized ? SDL_max(value / 127.0f, -1.0f) : value;
+	}
+	case fastgltf::ComponentType::UnsignedByte: {
+		Uint8 value;
+		SDL_memcpy(&value, element + i * sizeof(value), sizeof(value));
+		return normalized ? value / 255.0f : value;
+	}
+	case fastgltf::ComponentType::Short: {
+		Sint16 value;
+		SDL_memcpy(&value, element + i * sizeof(value), sizeof(value));
+		return normalized ? SDL_max(value / 32767.0f, -1.0f) : value;
+	}
+	case fastgltf::ComponentType::UnsignedShort: {
+		Uint16 value;
+		SDL_memcpy(&value, element + i * sizeof(value), sizeof(value));
+		return normalized ? value / 65535.0f : value;
+	}
+	case fastgltf::ComponentType::Float: {
+		float value;
+		SDL_memcpy(&value, element + i * sizeof(value), sizeof(value));
+		return value;
+	}
+	default:
+		return 0;
+	}
+}
+
+// findAttribute returns the end of the attributes when the primitive doesn't have one
+static bool hasAttribute(const fastgltf::Primitive &prim, std::string_view name) {
+	return prim.findAttribute(name) != prim.attributes.end();
+}
+
+// read an index of any width
+static Uint32 readIndex(const std::byte *element, const fastgltf::ComponentType &type) {
+	switch(type) {
+	case fastgltf::ComponentType::UnsignedByte:
+		return std::to_integer<Uint32>(*element);
+	case fastgltf::ComponentType::UnsignedShort: {
+		Uint16 value;
+		SDL_memcpy(&value, element, sizeof(value));
+		return value;
+	}
+	default: {
+		Uint32 value;
+		SDL_memcpy(&value, element, sizeof(value));
+		return value;
+	}
+	}
+}
+
+// compact vertex format of a vec3 attribute, every element padded to 4 bytes as glTF requires
+// positions that are not normalized are scaled back by VertexLayout::position_scale
+struct AttributeFormat {
+	SDL_GPUVertexElementFormat format { SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3 };
+	Uint32 pitch { sizeof(glm::vec3) };
+	float scale { 1 };
+	bool operator==(const AttributeFormat &other) const = default;
+};
+static AttributeFormat attributeFormat(const fastgltf::Accessor &accessor) {
+	switch(accessor.componentType) {
+	case fastgltf::ComponentType::Byte:
+		return { SDL_GPU_VERTEXELEMENTFORMAT_BYTE4_NORM, 4, accessor.normalized ? 1.0f : 127.0f };
+	case fastgltf::ComponentType::UnsignedByte:
+		return { SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM, 4, accessor.normalized ? 1.0f : 255.0f };
+	case fastgltf::ComponentType::Short:
+		return { SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM, 8, accessor.normalized ? 1.0f : 32767.0f };
+	case fastgltf::ComponentType::UnsignedShort:
+		return { SDL_GPU_VERTEXELEMENTFORMAT_USHORT4_NORM, 8, accessor.normalized ? 1.0f : 65535.0f };
+	default:
+		return { };
+	}
+}
+
+// bytes of an image & its mime type, empty when the image isn't in memory
+static std::span<const std::byte> imageBytes(const fastgltf::Asset &asset, const fastgltf::Image &image, fastgltf::MimeType &mime) {
+	return std::visit([&](const auto &source) -> std::span<const std::byte> {
+		using Source = std::decay_t<decltype(source)>;
+		if constexpr (std::is_same_v<Source, fastgltf::sources::BufferView>) {
+			const fastgltf::BufferView &view { asset.bufferViews.at(source.bufferViewIndex) };
+			const std::byte *bytes { bufferBytes(asset.buffers.at(view.bufferIndex)) };
+			mime = source.mimeType;
+			if (!bytes) { return { }; }
+			return { bytes + view.byteOffset, view.byteLength };
+		} else if constexpr (requires { source.bytes.data(); source.mimeType; }) {
+			mime = source.mimeType;
+			return { reinterpret_cast<const std::byte*>(source.bytes.data()), source.bytes.size() };
+		} else {
+			return { };
+		}
+	}, image.data);
+}
+
+// transcode every mip level of a KTX2/Basis texture, runs on the background thread
+static bool transcodeKTX2(const std::vector<std::byte> &ktx2, const basist::transcoder_texture_format &format, StreamedTexture &texture) {
+	basist::ktx2_transcoder transcoder;
+	if (!transcoder.init(ktx2.data(), static_cast<Uint32>(ktx2.size())) || !transcoder.start_transcoding()) {
+		return false;
+	}
+	texture.width = transcoder.get_width();
+	texture.height = transcoder.get_height();
+	texture.levels.resize(transcoder.get_levels());
+	const Uint32 unit_bytes { basist::basis_get_bytes_per_block_or_pixel(format) };
+	const bool uncompressed { basist::basis_transcoder_format_is_uncompressed(format) };
+	for (Uint32 level = 0; level < texture.levels.size(); ++level) {
+		basist::ktx2_image_level_info info;
+		if (!transcoder.get_image_level_info(info, level, 0, 0)) { return false; }
+		const Uint32 units { uncompressed ? info.m_orig_width * info.m_orig_height : info.m_total_blocks };
+		texture.levels[level].resize(units * unit_bytes);
+		if (!transcoder.transcode_image_level(level, 0, 0, texture.levels[level].data(), units, format)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Uint32 RangeAllocator::allocate(const Uint32 &count) {
+	if (!count) { return 0; }
+	for (std::map<Uint32, Uint32>::iterator range { m_free.begin() }; range != m_free.end(); ++range) {
+		if (range->second < count) { continue; }
+		const Uint32 first { range->first };
+		const Uint32 remaining { range->second - count };
+		m_free.erase(range);
+		if (remaining) { m_free.emplace(first + count, remaining); }
+		return first;
+	}
+	// nothing fits, grow & start in the free range at the end if there is one
+	Uint32 first { m_capacity };
+	if (!m_free.empty()) {
+		const std::map<Uint32, Uint32>::iterator last { std::prev(m_free.end()) };
+		if (last->first + last->second == m_capacity) {
+			first = last->first;
+			m_free.erase(last);
+		}
+	}
+	const Uint32 capacity { SDL_max(first + count, m_capacity * 2) };
+	if (capacity > first + count) { m_free.emplace(first + count, capacity - first - count); }
+	m_capacity = capacity;
+	return first;
+}
+
+void RangeAllocator::free(const Uint32 &first, const Uint32 &count) {
+	if (!count) { return; }
+	std::map<Uint32, Uint32>::iterator range { m_free.emplace(first, count).first };
+	// merge with the following range
+	if (const std::map<Uint32, Uint32>::iterator next { std::next(range) }; next != m_free.end() && first + count == next->first) {
+		range->second += next->second;
+		m_free.erase(next);
+	}
+	// merge with the preceding range
+	if (range != m_free.begin()) {
+		const std::map<Uint32, Uint32>::iterator prev { std::prev(range) };
+		if (prev->first + prev->second == first) {
+			prev->second += range->second;
+			m_free.erase(range);
+		}
+	}
+}
+
+Uint32 RangeAllocator::end() const {
+	if (m_free.empty()) { return m_capacity; }
+	const std::map<Uint32, Uint32>::const_iterator last { std::prev(m_free.end()) };
+	return last->first + last->second == m_capacity ? last->first : m_capacity;
+}
+
+Scene::Scene() { }
+Scene::~Scene() { }
+
+void Scene::init(SDL_GPUDevice *gpu, JobSystem *jobs) {
+	m_gpu = gpu;
+	m_jobs = jobs;
+	m_parser = std::make_unique<fastgltf::Parser>(
+		fastgltf::Extensions::KHR_mesh_quantization |
+		fastgltf::Extensions::EXT_meshopt_compression |
+		fastgltf::Extensions::KHR_texture_basisu
+	);
+	m_instances.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+	m_instance_ids.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
+	m_visibility.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+
+	// transcode to the best block compressed format the backend samples, uncompressed as a last resort
+	basist::basisu_transcoder_init();
+	const std::pair<SDL_GPUTextureFormat, basist::transcoder_texture_format> formats[3] {
+		{ SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM, basist::transcoder_texture_format::cTFBC7_RGBA },
+		{ SDL_GPU_TEXTUREFORMAT_ASTC_4x4_UNORM, basist::transcoder_texture_format::cTFASTC_4x4_RGBA },
+		{ SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, basist::transcoder_texture_format::cTFRGBA32 },
+	};
+	for (const std::pair<SDL_GPUTextureFormat, basist::transcoder_texture_format> &format : formats) {
+		if (SDL_GPUTextureSupportsFormat(m_gpu, format.first, SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+			m_texture_format = format.first;
+			m_transcode_format = static_cast<Uint32>(format.second);
+			break;
+		}
+	}
+}
+
+void Scene::quit() {
+	while (!m_textures.empty()) {
+		releaseTexture(m_textures.begin()->first);
+	}
+	if (m_texture_transfer_buf.get()) { m_texture_transfer_buf.release(); }
+	for (GeometryPool &pool : m_pools) {
+		for (GPUGrowableBuffer *buf : { &pool.indices, &pool.verts, &pool.norms, &pool.uvs, &pool.draws, &pool.commands, &pool.order }) {
+			buf->release();
+		}
+	}
+	m_pools.clear();
+	m_instances.release();
+	m_instance_ids.release();
+	m_visibility.release();
+	if (m_instance_transfer_buf.get()) { m_instance_transfer_buf.release(); }
+	if (m_visibility_transfer_buf.get()) { m_visibility_transfer_buf.release(); }
+	if (m_command_transfer_buf.get()) { m_command_transfer_buf.release(); }
+	m_objects.clear();
+	m_assets.clear();
+}
+
+Uint32 Scene::poolFor(const VertexLayout &layout) {
+	for (Uint32 i = 0; i < m_pools.size(); ++i) {
+		if (m_pools[i].layout == layout) { return i; }
+	}
+	GeometryPool &pool { m_pools.emplace_back() };
+	pool.layout = layout;
+	pool.indices.usage = SDL_GPU_BUFFERUSAGE_INDEX;
+	pool.verts.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
+	pool.norms.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
+	pool.uvs.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
+	pool.draws.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+	pool.commands.usage = SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE;
+	pool.order.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+	return static_cast<Uint32>(m_pools.size() - 1);
+}
+
+std::optional<AssetHandle> Scene::add(const std::filesystem::path &path, const glm::mat4 &transform) {
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Loading GLTF file: %s", path.c_str());
+	const Uint64 load_start { SDL_GetTicksNS() };
+	const Uint64 allocations_start { heapAllocations() };
+	// scratch of this load is released on every return path
+	struct ArenaRelease {
+		std::pmr::monotonic_buffer_resource &arena;
+		~ArenaRelease() { arena.release(); }
+	} arena_release { m_load_arena };
+	fastgltf::Expected<fastgltf::GltfDataBuffer> data = fastgltf::GltfDataBuffer::FromPath(path);
+	if (data.error() != fastgltf::Error::None) {
+		switch(data.error()) {
+		case fastgltf::Error::InvalidPath:
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Invalid path, resuming application");
+			break;
+		case fastgltf::Error::InvalidFileData:
+		case fastgltf::Error::InvalidGLB:
+		case fastgltf::Error::InvalidGltf:
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Invalid data, resuming application");
+			break;
+		default:
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Error occured while parsing file, resuming application");
+			break;
+		}
+		return std::nullopt;
+	}
+	auto asset { m_parser->loadGltf(
+			data.get(),
+			path.parent_path(),
+			fastgltf::Options::DecomposeNodeMatrices |
+			fastgltf::Options::LoadExternalBuffers |
+			fastgltf::Options::LoadExternalImages |
+			fastgltf::Options::GenerateMeshIndices
+	) };
+	if (asset.error() != fastgltf::Error::None) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Error occured while loading gltf, resuming application");
+		return std::nullopt;
+	}
+
+	// decode meshopt compressed buffer views in parallel, views that are not compressed stay empty
+	// sized up front, the arena can't be allocated from by workers
+	std::pmr::vector<std::pmr::vector<std::byte>> decoded_views(asset->bufferViews.size(), &m_load_arena);
+	std::pmr::vector<Uint32> compressed_views { &m_load_arena };
+	for (Uint32 i = 0; i < asset->bufferViews.size(); ++i) {
+		if (const std::unique_ptr<fastgltf::CompressedBufferView> &meshopt { asset->bufferViews[i].meshoptCompression }; meshopt) {
+			compressed_views.push_back(i);
+			decoded_views[i].resize(meshopt->count * meshopt->byteStride);
+		}
+	}
+	std::atomic<bool> decode_failed { false };
+	m_jobs->parallelFor(static_cast<Uint32>(compressed_views.size()), 1, [&](Uint32 begin, Uint32 end) {
+		for (Uint32 i = begin; i < end; ++i) {
+			const fastgltf::CompressedBufferView &meshopt { *asset->bufferViews[compressed_views[i]].meshoptCompression };
+			const std::byte *source_bytes { bufferBytes(asset->buffers.at(meshopt.bufferIndex)) };
+			if (!source_bytes) {
+				decode_failed = true;
+				continue;
+			}
+			const unsigned char *source { reinterpret_cast<const unsigned char*>(source_bytes + meshopt.byteOffset) };
+			std::pmr::vector<std::byte> &decoded { decoded_views[compressed_views[i]] };
+			int result { -1 };
+			switch(meshopt.mode) {
+			case fastgltf::MeshoptCompressionMode::Attributes:
+				result = meshopt_decodeVertexBuffer(decoded.data(), meshopt.count, meshopt.byteStride, source, meshopt.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Triangles:
+				result = meshopt_decodeIndexBuffer(decoded.data(), meshopt.count, meshopt.byteStride, source, meshopt.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Indices:
+				result = meshopt_decodeIndexSequence(decoded.data(), meshopt.count, meshopt.byteStride, source, meshopt.byteLength);
+				break;
+			default:
+				break;
+			}
+			if (result != 0) {
+				decode_failed = true;
+				continue;
+			}
+			switch(meshopt.filter) {
+			case fastgltf::MeshoptCompressionFilter::Octahedral:
+				meshopt_decodeFilterOct(decoded.data(), meshopt.count, meshopt.byteStride);
+				break;
+			case fastgltf::MeshoptCompressionFilter::Quaternion:
+				meshopt_decodeFilterQuat(decoded.data(), meshopt.count, meshopt.byteStride);
+				break;
+			case fastgltf::MeshoptCompressionFilter::Exponential:
+				meshopt_decodeFilterExp(decoded.data(), meshopt.count, meshopt.byteStride);
+				break;
+			default:
+				break;
+			}
+		}
+	});
+	if (decode_failed) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Error occured while decoding meshopt compressed data, resuming application");
+		return std::nullopt;
+	}
+
+	// elements of an accessor, from the decoded view if it was compressed
+	struct AccessorData {
+		const std::byte *data;
+		Uint32 stride;
+		Uint32 element_size;
+	};
+	auto accessorData = [&](const fastgltf::Accessor &access) -> AccessorData {
+		SDL_assert(access.bufferViewIndex.has_value());
+		const std::size_t view_index { access.bufferViewIndex.value() };
+		const fastgltf::BufferView &view { asset->bufferViews.at(view_index) };
+		const Uint32 element_size { static_cast<Uint32>(fastgltf::getElementByteSize(access.type, access.componentType)) };
+		const std::byte *view_data { decoded_views[view_index].empty()
+			? bufferBytes(asset->buffers.at(view.bufferIndex)) + view.byteOffset
+			: decoded_views[view_index].data() };
+		return {
+			view_data + access.byteOffset,
+			view.byteStride.has_value() ? static_cast<Uint32>(view.byteStride.value()) : element_size,
+			element_size
+		};
+	};
+
+	auto processPrimitive = [&](const fastgltf::Primitive &prim) -> GeometryAllocationInfo {
+		switch(prim.type) {
+			case fastgltf::PrimitiveType::Triangles:
+				break;
+			default:
+				SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Primitive types other than triangle lists are not supported");
+				break;
+		}
+		const fastgltf::Attribute *pos { prim.findAttribute("POSITION") };
+		const fastgltf::Attribute *norm { prim.findAttribute("NORMAL") };
+
+		SDL_assert(prim.indicesAccessor.has_value());
+		fastgltf::Accessor &index_access { asset->accessors.at(prim.indicesAccessor.value()) };
+		fastgltf::Accessor &vertex_access { asset->accessors.at(pos->accessorIndex) };
+		fastgltf::Accessor &normal_access { asset->accessors.at(norm->accessorIndex) };
+		// bytes are filled in once the vertex layout of the whole file is known
+		const GeometryAllocationInfo info {
+			{ 0, static_cast<Uint32>(index_access.count), },
+			{ 0, static_cast<Uint32>(vertex_access.count) },
+			{ 0, static_cast<Uint32>(normal_access.count) }
+		};
+		return info;
+	};
+
+	// a cluster of a primitive's triangles, culled & drawn on its own
+	struct Meshlet {
+		Uint32 first_index, num_indices; // into the primitive's reordered indices
+		glm::vec4 sphere, cone;
+	};
+	// primitives in draw order, with their offsets into the asset's ranges
+	struct PrimitiveUpload {
+		const fastgltf::Primitive *prim;
+		GeometryAllocationInfo offsets;
+		glm::vec3 min, max;
+		Uint32 mesh, material;
+		// written by the worker that builds the primitive's meshlets
+		std::vector<Uint32> indices; // triangles of every meshlet, one meshlet after another
+		std::vector<Meshlet> meshlets;
+	};
+	std::pmr::vector<PrimitiveUpload> primitives { &m_load_arena };
+	std::pmr::vector<Mesh> meshes { &m_load_arena };
+	std::pmr::vector<GPUDraw> draws { &m_load_arena };
+	GeometryAllocationInfo asset_buffer_info;
+	// traverse nodes, TRS includes the transforms of parent nodes
+	fastgltf::iterateSceneNodes(asset.get(), asset->defaultScene.value(), fastgltf::math::fmat4x4(), 
+								[&](fastgltf::Node &node, fastgltf::math::fmat4x4 TRS) {
+		// nodes without a mesh only contribute transforms
+		if (!node.meshIndex.has_value()) { return; }
+		glm::mat4 node_transform;
+		for (Uint32 column = 0; column < 4; ++column) {
+			for (Uint32 row = 0; row < 4; ++row) {
+				node_transform[column][row] = TRS[column][row];
+			}
+		}
+		const fastgltf::Mesh &mesh { asset->meshes.at(node.meshIndex.value()) };
+		const Uint32 instance { static_cast<Uint32>(meshes.size()) };
+		// each primitive indexes its own vertices, its meshlets become its draws
+		for (const fastgltf::Primitive &prim : mesh.primitives) {
+			// both are optional in glTF, normals aren't generated so the primitive is left out
+			if (!hasAttribute(prim, "POSITION") || !hasAttribute(prim, "NORMAL")) {
+				SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Skipping a primitive of mesh %zu without POSITION or NORMAL", node.meshIndex.value());
+				continue;
+			}
+			const GeometryAllocationInfo prim_info { processPrimitive(prim) };
+			// primitives without a material use the default one, after the file's materials
+			const Uint32 material { static_cast<Uint32>(prim.materialIndex.value_or(asset->materials.size())) };
+			primitives.push_back({ &prim, asset_buffer_info, { }, { }, instance, material });
+			asset_buffer_info += prim_info;
+		}
+		// draws are counted once the meshlets are built
+		meshes.push_back({ node_transform, { }, { }, 0, m_next_asset });
+	});
+	if (primitives.empty()) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Asset has no geometry, resuming application");
+		return std::nullopt;
+	}
+
+	// split primitives into meshlets, each one reorders its own indices
+	m_jobs->parallelFor(static_cast<Uint32>(primitives.size()), 1, [&](Uint32 begin, Uint32 end) {
+		for (Uint32 i = begin; i < end; ++i) {
+			PrimitiveUpload &upload { primitives[i] };
+			const fastgltf::Accessor &i_access { asset->accessors.at(upload.prim->indicesAccessor.value()) };
+			const fastgltf::Accessor &v_access { asset->accessors.at(upload.prim->findAttribute("POSITION")->accessorIndex) };
+
+			// positions as the vertex shader sees them after position_scale
+			const AccessorData position_source { accessorData(v_access) };
+			std::vector<glm::vec3> positions(v_access.count);
+			glm::vec3 min { std::numeric_limits<float>::max() }, max { std::numeric_limits<float>::lowest() };
+			for (Uint32 v = 0; v < v_access.count; ++v) {
+				const std::byte *element { position_source.data + v * position_source.stride };
+				positions[v] = {
+					readComponent(element, v_access.componentType, v_access.normalized, 0),
+					readComponent(element, v_access.componentType, v_access.normalized, 1),
+					readComponent(element, v_access.componentType, v_access.normalized, 2),
+				};
+				min = glm::min(min, positions[v]);
+				max = glm::max(max, positions[v]);
+			}
+			upload.min = min;
+			upload.max = max;
+			if (positions.empty()) { continue; }
+			const AccessorData index_source { accessorData(i_access) };
+			std::vector<Uint32> indices(i_access.count);
+			for (Uint32 index = 0; index < i_access.count; ++index) {
+				indices[index] = readIndex(index_source.data + index * index_source.stride, i_access.componentType);
+			}
+
+			const std::size_t max_meshlets { meshopt_buildMeshletsBound(indices.size(), meshlet_vertices, meshlet_triangles) };
+			std::vector<meshopt_Meshlet> meshlets(max_meshlets);
+			std::vector<unsigned int> vertices(max_meshlets * meshlet_vertices);
+			std::vector<unsigned char> triangles(max_meshlets * meshlet_triangles * 3);
+			meshlets.resize(meshopt_buildMeshlets(meshlets.data(), vertices.data(), triangles.data(),
+					indices.data(), indices.size(), &positions[0].x, positions.size(), sizeof(glm::vec3),
+					meshlet_vertices, meshlet_triangles, meshlet_cone_weight));
+			// meshlets keep every triangle, the indices are only reordered so each meshlet is one range
+			upload.indices.reserve(indices.size());
+			upload.meshlets.reserve(meshlets.size());
+			for (const meshopt_Meshlet &meshlet : meshlets) {
+				const meshopt_Bounds bounds { meshopt_computeMeshletBounds(&vertices[meshlet.vertex_offset], &triangles[meshlet.triangle_offset],
+						meshlet.triangle_count, &positions[0].x, positions.size(), sizeof(glm::vec3)) };
+				upload.meshlets.push_back({
+					.first_index = static_cast<Uint32>(upload.indices.size()),
+					.num_indices = meshlet.triangle_count * 3,
+					.sphere = { bounds.center[0], bounds.center[1], bounds.center[2], bounds.radius },
+					.cone = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2], bounds.cone_cutoff },
+				});
+				for (Uint32 t = 0; t < meshlet.triangle_count * 3; ++t) {
+					upload.indices.push_back(vertices[meshlet.vertex_offset + triangles[meshlet.triangle_offset + t]]);
+				}
+			}
+		}
+	});
+	// one draw per meshlet, with the primitive it came from for ordering by material
+	std::pmr::vector<Uint32> draw_primitives { &m_load_arena };
+	for (Uint32 i = 0; i < primitives.size(); ++i) {
+		const PrimitiveUpload &upload { primitives[i] };
+		for (const Meshlet &meshlet : upload.meshlets) {
+			draws.push_back({
+				.sphere = meshlet.sphere,
+				.cone = meshlet.cone,
+				.instance = upload.mesh,
+				.first_index = upload.offsets.indices.count + meshlet.first_index,
+				.num_indices = meshlet.num_indices,
+				.vertex_offset = static_cast<Sint32>(upload.offsets.verts.count),
+			});
+			draw_primitives.push_back(i);
+		}
+		meshes[upload.mesh].num_draws += static_cast<Uint32>(upload.meshlets.size());
+	}
+	if (draws.empty()) {
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Asset has no triangles, resuming application");
+		return std::nullopt;
+	}
+
+	// quantized attributes stay compact when every primitive agrees on their format,
+	// otherwise they are expanded to float
+	auto primitiveAccessor = [&](const PrimitiveUpload &upload, std::string_view attribute) -> const fastgltf::Accessor& {
+		return asset->accessors.at(upload.prim->findAttribute(attribute)->accessorIndex);
+	};
+	const AttributeFormat position_format { attributeFormat(primitiveAccessor(primitives.front(), "POSITION")) };
+	const AttributeFormat normal_format { attributeFormat(primitiveAccessor(primitives.front(), "NORMAL")) };
+	bool compact_positions { true }, compact_normals { true }, wide_indices { false };
+	for (const PrimitiveUpload &upload : primitives) {
+		compact_positions = compact_positions && attributeFormat(primitiveAccessor(upload, "POSITION")) == position_format;
+		compact_normals = compact_normals && attributeFormat(primitiveAccessor(upload, "NORMAL")) == normal_format;
+		wide_indices = wide_indices || asset->accessors.at(upload.prim->indicesAccessor.value()).componentType == fastgltf::ComponentType::UnsignedInt;
+	}
+	const AttributeFormat positions { compact_positions ? position_format : AttributeFormat { } };
+	const AttributeFormat normals { compact_normals ? normal_format : AttributeFormat { } };
+	const VertexLayout layout {
+		.position = positions.format,
+		.normal = normals.format,
+		.position_pitch = positions.pitch,
+		.normal_pitch = normals.pitch,
+		.position_scale = positions.scale,
+		.index_size = wide_indices ? SDL_GPU_INDEXELEMENTSIZE_32BIT : SDL_GPU_INDEXELEMENTSIZE_16BIT,
+	};
+	const Uint32 index_bytes { wide_indices ? 4u : 2u };
+	// 16 bit index ranges are kept to an even count, so every range starts 4 byte aligned
+	const Uint32 index_slots { wide_indices ? asset_buffer_info.indices.count : (asset_buffer_info.indices.count + 1) & ~1u };
+	for (PrimitiveUpload &upload : primitives) {
+		upload.offsets.indices.bytes = upload.offsets.indices.count * index_bytes;
+		upload.offsets.verts.bytes = upload.offsets.verts.count * layout.position_pitch;
+		upload.offsets.norms.bytes = upload.offsets.norms.count * layout.normal_pitch;
+	}
+	asset_buffer_info.indices.bytes = asset_buffer_info.indices.count * index_bytes;
+	asset_buffer_info.verts.bytes = asset_buffer_info.verts.count * layout.position_pitch;
+	asset_buffer_info.norms.bytes = asset_buffer_info.norms.count * layout.normal_pitch;
+
+	// reserve ranges in the shared buffers, positions & normals share the vertex range
+	const Uint32 pool_index { poolFor(layout) };
+	GeometryPool &pool { m_pools[pool_index] };
+	Asset placed {
+		.transform = transform,
+		.pool = pool_index,
+		.first_index = pool.index_ranges.allocate(index_slots),
+		.num_indices = index_slots,
+		.first_vertex = pool.vertex_ranges.allocate(asset_buffer_info.verts.count),
+		.num_vertices = asset_buffer_info.verts.count,
+		.first_draw = pool.draw_ranges.allocate(static_cast<Uint32>(draws.size())),
+		.num_draws = static_cast<Uint32>(draws.size()),
+		.first_instance = m_instance_ranges.allocate(static_cast<Uint32>(meshes.size())),
+		.num_instances = static_cast<Uint32>(meshes.size()),
+	};
+	// move the asset's draws & meshes into their ranges
+	for (GPUDraw &draw : draws) {
+		draw.instance += placed.first_instance;
+		draw.first_index += placed.first_index;
+		draw.vertex_offset += static_cast<Sint32>(placed.first_vertex);
+	}
+	placed.name = path.filename().string();
+	placed.load_start = load_start;
+
+	// materials, base color textures start transcoding on workers while the geometry is decoded
+	std::pmr::unordered_map<std::size_t, Uint32> image_textures { &m_load_arena };
+	for (const fastgltf::Material &material : asset->materials) {
+		Material &placed_material { placed.materials.emplace_back() };
+		for (Uint32 c = 0; c < 4; ++c) {
+			placed_material.base_color[c] = material.pbrData.baseColorFactor[c];
+		}
+		if (!material.pbrData.baseColorTexture.has_value()) { continue; }
+		const fastgltf::Texture &texture { asset->textures.at(material.pbrData.baseColorTexture->textureIndex) };
+		const std::optional<std::size_t> image_index { texture.basisuImageIndex.has_value() ? texture.basisuImageIndex : texture.imageIndex };
+		if (!image_index.has_value()) { continue; }
+		if (const std::pmr::unordered_map<std::size_t, Uint32>::const_iterator shared { image_textures.find(image_index.value()) }; shared != image_textures.end()) {
+			placed_material.texture = shared->second;
+			continue;
+		}
+		fastgltf::MimeType mime { fastgltf::MimeType::None };
+		const std::span<const std::byte> bytes { imageBytes(asset.get(), asset->images.at(image_index.value()), mime) };
+		// only KTX2 is transcoded, other images keep the base color factor
+		if (mime != fastgltf::MimeType::KTX2 || bytes.empty()) {
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Image %zu is not KTX2, using the base color factor", image_index.value());
+			continue;
+		}
+		const Uint32 id { m_next_texture++ };
+		StreamedTexture &streamed { *m_textures.emplace(id, std::make_unique<StreamedTexture>()).first->second };
+		streamed.asset = m_next_asset;
+		streamed.transcode = m_jobs->submitBackground([&streamed, ktx2 = std::vector<std::byte>(bytes.begin(), bytes.end()), format = m_transcode_format] {
+			if (!transcodeKTX2(ktx2, static_cast<basist::transcoder_texture_format>(format), streamed)) {
+				streamed.failed = true;
+				streamed.levels.clear();
+			}
+			streamed.resident_level = static_cast<Uint32>(streamed.levels.size());
+			// wake the main loop if it is idle, the levels are uploaded with the next frame
+			SDL_Event wake { .type = SDL_EVENT_USER };
+			SDL_PushEvent(&wake);
+		});
+		image_textures.emplace(image_index.value(), id);
+		placed_material.texture = id;
+	}
+	// the default material keeps the flat color assets had before materials were imported
+	placed.materials.push_back({ .base_color = { 0.6f, 0.3f, 0.2f, 1.0f } });
+	// give back everything reserved for the asset when it can't be uploaded
+	auto discard = [&] {
+		pool.index_ranges.free(placed.first_index, placed.num_indices);
+		pool.vertex_ranges.free(placed.first_vertex, placed.num_vertices);
+		pool.draw_ranges.free(placed.first_draw, placed.num_draws);
+		m_instance_ranges.free(placed.first_instance, placed.num_instances);
+		for (const std::pair<const std::size_t, Uint32> &texture : image_textures) {
+			releaseTexture(texture.second);
+		}
+	};
+
+	// geometry of every primitive is packed into one transfer buffer laid out like the asset's ranges,
+	// the vertex sections start 4 byte aligned after the indices
+	const Uint32 verts_start { (asset_buffer_info.indices.bytes + 3) & ~3u };
+	const Uint32 norms_start { verts_start + asset_buffer_info.verts.bytes };
+	const Uint32 uvs_start { norms_start + asset_buffer_info.norms.bytes };
+	const Uint32 uv_bytes { asset_buffer_info.verts.count * static_cast<Uint32>(sizeof(glm::vec2)) };
+	const Uint32 draws_start { uvs_start + uv_bytes };
+	const Uint32 draw_bytes { static_cast<Uint32>(draws.size() * sizeof(GPUDraw)) };
+	// instance ids are the identity, only ids of newly grown capacity are uploaded
+	const Uint32 old_instance_capacity { static_cast<Uint32>(m_objects.size()) };
+	const Uint32 new_instance_ids { m_instance_ranges.capacity() - old_instance_capacity };
+	const Uint32 ids_start { draws_start + draw_bytes };
+	GPUResource<TRANSFER_BUFFER> transfer_buf;
+	transfer_buf.info = {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = ids_start + new_instance_ids * static_cast<Uint32>(sizeof(Uint32)),
+	};
+	if (!transfer_buf.create(m_gpu)) {
+		discard();
+		return std::nullopt;
+	}
+	Uint8 *geometry_data { static_cast<Uint8*>(SDL_MapGPUTransferBuffer(m_gpu, transfer_buf.get(), false)) };
+	if (!geometry_data) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MapGPUTransferBuffer failed:\n\t%s", SDL_GetError());
+		transfer_buf.release();
+		discard();
+		return std::nullopt;
+	}
+
+	// copy a vec3 attribute, either as is into its compact format or expanded to float
+	auto copyAttribute = [&](const fastgltf::Accessor &access, const AttributeFormat &format, Uint8 *dest) {
+		const AccessorData source { accessorData(access) };
+		for (Uint32 v = 0; v < access.count; ++v) {
+			const std::byte *element { source.data + v * source.stride };
+			Uint8 *out { dest + v * format.pitch };
+			if (format.format == SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3) {
+				const glm::vec3 value {
+					readComponent(element, access.componentType, access.normalized, 0),
+					readComponent(element, access.componentType, access.normalized, 1),
+					readComponent(element, access.componentType, access.normalized, 2),
+				};
+				SDL_memcpy(out, &value, sizeof(value));
+			} else {
+				SDL_memcpy(out, element, source.element_size);
+				SDL_memset(out + source.element_size, 0, format.pitch - source.element_size);
+			}
+		}
+	};
+
+	// decode primitives in parallel, each one writes to its own region of the transfer buffer
+	m_jobs->parallelFor(static_cast<Uint32>(primitives.size()), 1, [&](Uint32 begin, Uint32 end) {
+		for (Uint32 i = begin; i < end; ++i) {
+			const fastgltf::Primitive &prim { *primitives[i].prim };
+			const GeometryAllocationInfo &offsets { primitives[i].offsets };
+			const fastgltf::Accessor &v_access { primitiveAccessor(primitives[i], "POSITION") };
+			const fastgltf::Accessor &norm_access { primitiveAccessor(primitives[i], "NORMAL") };
+
+			// indices in meshlet order
+			Uint8 *i_data { geometry_data + offsets.indices.bytes };
+			for (Uint32 index = 0; index < primitives[i].indices.size(); ++index) {
+				const Uint32 value { primitives[i].indices[index] };
+				if (wide_indices) {
+					SDL_memcpy(i_data + index * sizeof(Uint32), &value, sizeof(Uint32));
+				} else {
+					const Uint16 narrow { static_cast<Uint16>(value) };
+					SDL_memcpy(i_data + index * sizeof(Uint16), &narrow, sizeof(Uint16));
+				}
+			}
+			copyAttribute(v_access, positions, geometry_data + verts_start + offsets.verts.bytes);
+			copyAttribute(norm_access, normals, geometry_data + norms_start + offsets.norms.bytes);
+
+			// texture coordinates are expanded to float, primitives without them read zero
+			Uint8 *uv_data { geometry_data + uvs_start + offsets.verts.count * sizeof(glm::vec2) };
+			SDL_memset(uv_data, 0, v_access.count * sizeof(glm::vec2));
+			if (hasAttribute(prim, "TEXCOORD_0")) {
+				const fastgltf::Accessor &uv_access { asset->accessors.at(prim.findAttribute("TEXCOORD_0")->accessorIndex) };
+				const AccessorData uv_source { accessorData(uv_access) };
+				for (Uint32 v = 0; v < SDL_min(uv_access.count, v_access.count); ++v) {
+					const std::byte *element { uv_source.data + v * uv_source.stride };
+					const glm::vec2 value {
+						readComponent(element, uv_access.componentType, uv_access.normalized, 0),
+						readComponent(element, uv_access.componentType, uv_access.normalized, 1),
+					};
+					SDL_memcpy(uv_data + v * sizeof(glm::vec2), &value, sizeof(value));
+				}
+			}
+		}
+	});
+	// order draws by material so each material is one range of slots, the pool's order merges them across assets
+	std::pmr::vector<Uint32> draw_order(draws.size(), &m_load_arena);
+	std::iota(draw_order.begin(), draw_order.end(), 0);
+	std::stable_sort(draw_order.begin(), draw_order.end(), [&](const Uint32 &a, const Uint32 &b) {
+		return primitives[draw_primitives[a]].material < primitives[draw_primitives[b]].material;
+	});
+	GPUDraw *draw_data { reinterpret_cast<GPUDraw*>(geometry_data + draws_start) };
+	if (pool.cpu_draws.size() < pool.draw_ranges.capacity()) {
+		pool.cpu_draws.resize(pool.draw_ranges.capacity());
+	}
+	for (Uint32 i = 0; i < draw_order.size(); ++i) {
+		const Uint32 material { primitives[draw_primitives[draw_order[i]]].material };
+		draw_data[i] = pool.cpu_draws[placed.first_draw + i] = draws[draw_order[i]];
+		if (placed.material_ranges.empty() || placed.material_ranges.back().material != material) {
+			placed.material_ranges.push_back({ material, placed.first_draw + i, 0 });
+		}
+		++placed.material_ranges.back().num_draws;
+	}
+	Uint32 *instance_id_data { reinterpret_cast<Uint32*>(geometry_data + ids_start) };
+	for (Uint32 i = 0; i < new_instance_ids; ++i) {
+		instance_id_data[i] = old_instance_capacity + i;
+	}
+	SDL_UnmapGPUTransferBuffer(m_gpu, transfer_buf.get());
+
+	// aabb of each mesh encloses its primitives
+	for (Mesh &mesh : meshes) {
+		mesh.min = glm::vec3(std::numeric_limits<float>::max());
+		mesh.max = glm::vec3(std::numeric_limits<float>::lowest());
+	}
+	for (const PrimitiveUpload &upload : primitives) {
+		meshes[upload.mesh].min = glm::min(meshes[upload.mesh].min, upload.min);
+		meshes[upload.mesh].max = glm::max(meshes[upload.mesh].max, upload.max);
+	}
+
+	// triangles for exact picking, each with a BVH over its triangles
+	if (exact_picking) {
+		placed.triangles.resize(meshes.size());
+		// primitives of a mesh are consecutive, (first, count) of each mesh
+		std::pmr::vector<std::pair<Uint32, Uint32>> mesh_primitives(meshes.size(), &m_load_arena);
+		for (Uint32 p = static_cast<Uint32>(primitives.size()); p-- > 0;) {
+			mesh_primitives[primitives[p].mesh].first = p;
+			++mesh_primitives[primitives[p].mesh].second;
+		}
+		m_jobs->parallelFor(static_cast<Uint32>(meshes.size()), 1, [&](Uint32 begin, Uint32 end) {
+			for (Uint32 m = begin; m < end; ++m) {
+				TriangleMesh &triangles { placed.triangles[m] };
+				const auto [first, count] { mesh_primitives[m] };
+				for (Uint32 p = first; p < first + count; ++p) {
+					const fastgltf::Accessor &v_access { primitiveAccessor(primitives[p], "POSITION") };
+					const fastgltf::Accessor &i_access { asset->accessors.at(primitives[p].prim->indicesAccessor.value()) };
+					const Uint32 base { static_cast<Uint32>(triangles.positions.size()) };
+					const AccessorData position_source { accessorData(v_access) };
+					for (Uint32 v = 0; v < v_access.count; ++v) {
+						const std::byte *element { position_source.data + v * position_source.stride };
+						triangles.positions.emplace_back(
+							readComponent(element, v_access.componentType, v_access.normalized, 0),
+							readComponent(element, v_access.componentType, v_access.normalized, 1),
+							readComponent(element, v_access.componentType, v_access.normalized, 2)
+						);
+					}
+					const AccessorData index_source { accessorData(i_access) };
+					for (Uint32 index = 0; index < i_access.count; ++index) {
+						triangles.indices.push_back(base + readIndex(index_source.data + index * index_source.stride, i_access.componentType));
+					}
+				}
+				std::vector<AABB> bounds(triangles.indices.size() / 3);
+				for (Uint32 t = 0; t < bounds.size(); ++t) {
+					for (Uint32 corner = 0; corner < 3; ++corner) {
+						bounds[t].grow(triangles.positions[triangles.indices[t * 3 + corner]]);
+					}
+				}
+				triangles.bvh.build(bounds);
+			}
+		});
+	}
+
+	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(m_gpu) };
+	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
+	// grow shared buffers to fit their ranges, existing contents are copied on the gpu
+	const bool reserved {
+		pool.indices.reserve(m_gpu, copypass, pool.index_ranges.capacity() * index_bytes) &&
+		pool.verts.reserve(m_gpu, copypass, pool.vertex_ranges.capacity() * layout.position_pitch) &&
+		pool.norms.reserve(m_gpu, copypass, pool.vertex_ranges.capacity() * layout.normal_pitch) &&
+		pool.uvs.reserve(m_gpu, copypass, pool.vertex_ranges.capacity() * static_cast<Uint32>(sizeof(glm::vec2))) &&
+		pool.draws.reserve(m_gpu, copypass, pool.draw_ranges.capacity() * static_cast<Uint32>(sizeof(GPUDraw))) &&
+		// commands are rewritten every frame, nothing to keep
+		pool.commands.reserve(m_gpu, nullptr, pool.draw_ranges.capacity() * static_cast<Uint32>(sizeof(SDL_GPUIndexedIndirectDrawCommand))) &&
+		m_instances.reserve(m_gpu, copypass, m_instance_ranges.capacity() * static_cast<Uint32>(sizeof(GPUInstance))) &&
+		m_instance_ids.reserve(m_gpu, copypass, m_instance_ranges.capacity() * static_cast<Uint32>(sizeof(Uint32)))
+	};
+	if (reserved) {
+		const SDL_GPUTransferBufferLocation locations[6] {
+			{ transfer_buf.get(), 0 },
+			{ transfer_buf.get(), verts_start },
+			{ transfer_buf.get(), norms_start },
+			{ transfer_buf.get(), uvs_start },
+			{ transfer_buf.get(), draws_start },
+			{ transfer_buf.get(), ids_start },
+		};
+		const SDL_GPUBufferRegion regions[6] {
+			{ pool.indices.get(), placed.first_index * index_bytes, index_slots * index_bytes },
+			{ pool.verts.get(), placed.first_vertex * layout.position_pitch, asset_buffer_info.verts.bytes },
+			{ pool.norms.get(), placed.first_vertex * layout.normal_pitch, asset_buffer_info.norms.bytes },
+			{ pool.uvs.get(), placed.first_vertex * static_cast<Uint32>(sizeof(glm::vec2)), uv_bytes },
+			{ pool.draws.get(), placed.first_draw * static_cast<Uint32>(sizeof(GPUDraw)), draw_bytes },
+			{ m_instance_ids.get(), old_instance_capacity * static_cast<Uint32>(sizeof(Uint32)), new_instance_ids * static_cast<Uint32>(sizeof(Uint32)) },
+		};
+		for (Uint32 i = 0; i < SDL_arraysize(regions); ++i) {
+			if (regions[i].size) {
+				SDL_UploadToGPUBuffer(copypass, &locations[i], &regions[i], false);
+			}
+		}
+	}
+	SDL_EndGPUCopyPass(copypass);
+	SDL_SubmitGPUCommandBuffer(cmdbuf);
+	transfer_buf.release();
+	if (!reserved) {
+		discard();
+		return std::nullopt;
+	}
+
+	// meshes are indexed by instance, their matrices are uploaded with the next frame
+	if (m_objects.size() < m_instance_ranges.capacity()) {
+		m_objects.resize(m_instance_ranges.capacity(), Mesh { .num_draws = 0 });
+	}
+	std::copy(meshes.begin(), meshes.end(), m_objects.begin() + placed.first_instance);
+	m_dirty_instances.emplace_back(placed.first_instance, placed.num_instances);
+	m_instances_computed = false;
+	const AssetHandle handle { m_next_asset++ };
+	const Asset &added { m_assets.emplace(handle, std::move(placed)).first->second };
+	for (const MaterialRange &range : added.material_ranges) {
+		pool.splices.push_back({ added.materials[range.material], range.first_draw, range.num_draws, false });
+	}
+	++m_revision;
+	m_bvh_changes.push_back({ BVHChange::Kind::added, added.first_instance, added.num_instances });
+
+	// compare against the same geometry as float3 attributes
+	const Uint32 gpu_bytes { asset_buffer_info.indices.bytes + asset_buffer_info.verts.bytes + asset_buffer_info.norms.bytes };
+	const Uint32 float_bytes { asset_buffer_info.indices.bytes + static_cast<Uint32>((asset_buffer_info.verts.count + asset_buffer_info.norms.count) * sizeof(glm::vec3)) };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Loaded %s in %.2f ms, %zu meshopt compressed buffer views, %zu textures streaming",
+			path.filename().c_str(), (SDL_GetTicksNS() - load_start) / 1e6, compressed_views.size(), image_textures.size());
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Load made %llu heap allocations",
+			static_cast<unsigned long long>(heapAllocations() - allocations_start));
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Geometry uses %u bytes on the gpu, %u bytes uncompressed (%.1fx), %llu bytes of gpu resources live",
+			gpu_bytes, float_bytes, static_cast<double>(float_bytes) / gpu_bytes, static_cast<unsigned long long>(GPUResourceRegistry::liveBytes()));
+	return handle;
+}
+
+void Scene::remove(const AssetHandle &handle) {
+	const std::unordered_map<AssetHandle, Asset>::iterator found { m_assets.find(handle) };
+	if (found == m_assets.end()) { return; }
+	const Asset &asset { found->second };
+	GeometryPool &pool { m_pools[asset.pool] };
+	// freed draw slots leave the pool's order before the next cull, their contents are never read again
+	for (const MaterialRange &range : asset.material_ranges) {
+		pool.splices.push_back({ asset.materials[range.material], range.first_draw, range.num_draws, true });
+	}
+
+	for (Uint32 i = asset.first_instance; i < asset.first_instance + asset.num_instances; ++i) {
+		m_objects[i].num_draws = 0;
+	}
+	for (const Material &material : asset.materials) {
+		if (material.texture != Material::no_texture) { releaseTexture(material.texture); }
+	}
+	pool.index_ranges.free(asset.first_index, asset.num_indices);
+	pool.vertex_ranges.free(asset.first_vertex, asset.num_vertices);
+	pool.draw_ranges.free(asset.first_draw, asset.num_draws);
+	m_instance_ranges.free(asset.first_instance, asset.num_instances);
+	m_bvh_changes.push_back({ BVHChange::Kind::removed, asset.first_instance, asset.num_instances });
+	m_assets.erase(found);
+	++m_revision;
+}
+
+void Scene::setTransform(const AssetHandle &handle, const glm::mat4 &transform) {
+	const std::unordered_map<AssetHandle, Asset>::iterator found { m_assets.find(handle) };
+	if (found == m_assets.end()) { return; }
+	found->second.transform = transform;
+	m_dirty_instances.emplace_back(found->second.first_instance, found->second.num_instances);
+	m_instances_computed = false;
+	++m_revision;
+	m_bvh_changes.push_back({ BVHChange::Kind::moved, found->second.first_instance, found->second.num_instances });
+}
+
+AABB Scene::worldBounds(const Uint32 &object) const {
+	const Mesh &mesh { m_objects[object] };
+	const std::unordered_map<AssetHandle, Asset>::const_iterator asset { m_assets.find(mesh.asset) };
+	if (!mesh.num_draws || asset == m_assets.end()) { return { }; }
+	return AABB { mesh.min, mesh.max }.transformed(asset->second.transform * mesh.model_mat());
+}
+
+void Scene::updateBVH() {
+	if (m_bvh_changes.empty()) { return; }
+	m_world_bounds.resize(m_objects.size());
+	Uint32 updates { 0 };
+	for (const BVHChange &change : m_bvh_changes) {
+		if (change.kind != BVHChange::Kind::moved) { updates += change.count; }
+	}
+	// inserts drift from what the SAH would build, rebuilding once as many objects changed as the tree holds
+	// keeps both the tree's quality & the cost per added or removed object bounded
+	if (m_bvh_updates + updates > m_bvh.size()) {
+		m_jobs->parallelFor(static_cast<Uint32>(m_objects.size()), 4096, [&](Uint32 begin, Uint32 end) {
+			for (Uint32 i = begin; i < end; ++i) {
+				m_world_bounds[i] = worldBounds(i);
+			}
+		});
+		const Uint64 start { SDL_GetTicksNS() };
+		m_bvh.build(m_world_bounds, m_jobs);
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Built BVH over %zu objects in %.2f ms, %zu nodes",
+				m_objects.size(), (SDL_GetTicksNS() - start) / 1e6, m_bvh.nodes().size());
+		m_bvh_updates = 0;
+	} else {
+		bool moved { false };
+		for (const BVHChange &change : m_bvh_changes) {
+			for (Uint32 i = change.first; i < change.first + change.count; ++i) {
+				m_world_bounds[i] = worldBounds(i);
+				if (change.kind == BVHChange::Kind::added) {
+					m_bvh.insert(i, m_world_bounds[i]);
+				} else if (change.kind == BVHChange::Kind::removed) {
+					m_bvh.remove(i);
+				}
+			}
+			moved = moved || change.kind == BVHChange::Kind::moved;
+		}
+		if (moved) { m_bvh.refit(m_world_bounds); }
+		m_bvh_updates += updates;
+	}
+	m_bvh_changes.clear();
+}
+
+void Scene::cull(const std::array<glm::vec4, 6> &planes, FrameArena &frame) {
+	updateBVH();
+	std::pmr::vector<Uint32> visible { &frame };
+	m_bvh.frustum(planes, visible);
+	for (GeometryPool &pool : m_pools) {
+		pool.visible = false;
+	}
+	std::pmr::vector<Uint32> bits((m_objects.size() + 31) / 32, 0, &frame);
+	for (const Uint32 &object : visible) {
+		const std::unordered_map<AssetHandle, Asset>::const_iterator asset { m_assets.find(m_objects[object].asset) };
+		if (asset == m_assets.end()) { continue; }
+		m_pools[asset->second.pool].visible = true;
+		bits[object / 32] |= 1u << (object % 32);
+	}
+	// a camera that only turns a little keeps the same objects in view, nothing to upload
+	if (!std::equal(bits.begin(), bits.end(), m_visibility_bits.begin(), m_visibility_bits.end())) {
+		m_visibility_bits.assign(bits.begin(), bits.end());
+		m_visibility_dirty = true;
+	}
+}
+
+CullPipeline::CullStats Scene::cullMeshlets(const std::array<glm::vec4, 6> &planes, const glm::vec3 &camera_pos) {
+	std::atomic<Uint64> submitted { 0 }, frustum_culled { 0 }, backface_culled { 0 };
+	// nothing was culled through the BVH yet
+	if (m_visibility_bits.empty()) { return { }; }
+	for (GeometryPool &pool : m_pools) {
+		pool.cpu_commands.resize(pool.cpu_order.size());
+		// pools out of view aren't drawn, their commands can be stale
+		if (pool.cpu_order.empty() || !pool.visible) { continue; }
+		pool.commands_pending = true;
+		m_jobs->parallelFor(static_cast<Uint32>(pool.cpu_order.size()), 4096, [&](Uint32 begin, Uint32 end) {
+			Uint64 chunk_submitted { 0 }, chunk_frustum { 0 }, chunk_backface { 0 };
+			for (Uint32 index = begin; index < end; ++index) {
+				const GPUDraw &draw { pool.cpu_draws[pool.cpu_order[index]] };
+				// the same tests as Cull.comp.hlsl, see there
+				bool in_frustum { ((m_visibility_bits[draw.instance / 32] >> (draw.instance % 32)) & 1) != 0 };
+				bool backfacing { false };
+				if (in_frustum) {
+					const glm::mat4 &model { m_models[draw.instance].model };
+					const glm::vec3 center { model * glm::vec4(glm::vec3(draw.sphere), 1) };
+					const glm::vec3 x_axis { model[0] }, y_axis { model[1] }, z_axis { model[2] };
+					const glm::vec3 sq_scale { glm::dot(x_axis, x_axis), glm::dot(y_axis, y_axis), glm::dot(z_axis, z_axis) };
+					const float max_sq_scale { SDL_max(sq_scale.x, SDL_max(sq_scale.y, sq_scale.z)) };
+					const float radius { draw.sphere.w * std::sqrt(max_sq_scale) };
+					for (const glm::vec4 &plane : planes) {
+						in_frustum = in_frustum && glm::dot(glm::vec3(plane), center) + plane.w > -radius;
+					}
+					const float tolerance { 1e-3f * max_sq_scale };
+					const bool conformal { std::abs(sq_scale.x - sq_scale.y) <= tolerance && std::abs(sq_scale.x - sq_scale.z) <= tolerance &&
+						std::abs(glm::dot(x_axis, y_axis)) <= tolerance && std::abs(glm::dot(x_axis, z_axis)) <= tolerance && std::abs(glm::dot(y_axis, z_axis)) <= tolerance };
+					const glm::vec3 axis { glm::normalize(glm::mat3(model) * glm::vec3(draw.cone)) };
+					const glm::vec3 view { center - camera_pos };
+					backfacing = conformal && glm::dot(view, axis) >= draw.cone.w * glm::length(view) + radius;
+				}
+				const bool visible { in_frustum && !backfacing };
+				const Uint32 triangles { draw.num_indices / 3 };
+				(visible ? chunk_submitted : (in_frustum ? chunk_backface : chunk_frustum)) += triangles;
+				pool.cpu_commands[index] = {
+					.num_indices = draw.num_indices,
+					.num_instances = visible ? 1u : 0u,
+					.first_index = draw.first_index,
+					.vertex_offset = draw.vertex_offset,
+					.first_instance = draw.instance,
+				};
+			}
+			submitted += chunk_submitted;
+			frustum_culled += chunk_frustum;
+			backface_culled += chunk_backface;
+		});
+	}
+	return { static_cast<Uint32>(submitted.load()), static_cast<Uint32>(frustum_culled.load()), static_cast<Uint32>(backface_culled.load()) };
+}
+
+// Möller-Trumbore, distance along direction to the triangle or std::nullopt for a miss
+static std::optional<float> intersectTriangle(const glm::vec3 &origin, const glm::vec3 &direction, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+	const glm::vec3 ab { b - a }, ac { c - a };
+	const glm::vec3 p { glm::cross(direction, ac) };
+	const float determinant { glm::dot(ab, p) };
+	// parallel to the triangle, both faces can be hit
+	if (glm::abs(determinant) < 1e-8f) { return std::nullopt; }
+	const float inv_determinant { 1.0f / determinant };
+	const glm::vec3 to_origin { origin - a };
+	const float u { glm::dot(to_origin, p) * inv_determinant };
+	if (u < 0 || u > 1) { return std::nullopt; }
+	const glm::vec3 q { glm::cross(to_origin, ab) };
+	const float v { glm::dot(direction, q) * inv_determinant };
+	if (v < 0 || u + v > 1) { return std::nullopt; }
+	const float t { glm::dot(ac, q) * inv_determinant };
+	if (t < 0) { return std::nullopt; }
+	return t;
+}
+
+std::optional<Scene::Pick> Scene::pick(const glm::vec3 &origin, const glm::vec3 &direction) {
+	updateBVH();
+	// objects that kept their triangles are hit exactly, the rest by their bounds
+	auto exact = [&](const Uint32 &object, const float &t_box, const float &t_max) -> std::optional<float> {
+		const Mesh &mesh { m_objects[object] };
+		const Asset &asset { m_assets.at(mesh.asset) };
+		if (asset.triangles.empty()) { return t_box; }
+		const TriangleMesh &triangles { asset.triangles[object - asset.first_instance] };
+		// the ray in the mesh's model space, the direction isn't normalized so distances stay in world units
+		const glm::mat4 to_model { glm::inverse(asset.transform * mesh.model_mat()) };
+		const glm::vec3 model_origin { to_model * glm::vec4(origin, 1) };
+		const glm::vec3 model_direction { to_model * glm::vec4(direction, 0) };
+		const std::optional<BVH::Hit> hit { triangles.bvh.raycast(model_origin, model_direction, t_max, [&](const Uint32 &triangle, const float &, const float &) {
+			return intersectTriangle(model_origin, model_direction,
+					triangles.positions[triangles.indices[triangle * 3]],
+					triangles.positions[triangles.indices[triangle * 3 + 1]],
+					triangles.positions[triangles.indices[triangle * 3 + 2]]);
+		}) };
+		if (!hit) { return std::nullopt; }
+		return hit->t;
+	};
+	const std::optional<BVH::Hit> hit { m_bvh.raycast(origin, direction, std::numeric_limits<float>::max(), exact) };
+	if (!hit) { return std::nullopt; }
+	return Pick { hit->primitive, hit->t };
+}
+
+void Scene::updateTransforms() {
+	if (!m_instances_computed && !m_dirty_instances.empty()) {
+		m_models.resize(m_objects.size());
+		for (const std::pair<Uint32, Uint32> &range : m_dirty_instances) {
+			const Uint32 first { range.first };
+			m_jobs->parallelFor(range.second, 1024, [&](Uint32 begin, Uint32 end) {
+				for (Uint32 i = first + begin; i < first + end; ++i) {
+					const Mesh &mesh { m_objects[i] };
+					const std::unordered_map<AssetHandle, Asset>::const_iterator asset { m_assets.find(mesh.asset) };
+					m_models[i].model = asset != m_assets.end() ? asset->second.transform * mesh.model_mat() : mesh.model_mat();
+				}
+			});
+		}
+		m_instances_computed = true;
+	}
+	updateBVH();
+}
+
+// pools keep their material ranges sorted by this
+static auto materialKey(const Material &material) {
+	return std::tuple { material.texture, material.base_color.r, material.base_color.g, material.base_color.b, material.base_color.a };
+}
+
+// put slot at position of the pool's order & remember to upload it
+static void setOrder(GeometryPool &pool, const Uint32 &position, const Uint32 &slot) {
+	pool.cpu_order[position] = slot;
+	pool.order_positions[slot] = position;
+	pool.order_changes.push_back(position);
+}
+
+// commands of a range are drawn in any order, so a range moves by count through moving at most count of its commands,
+// from one end to the other, every range after the given one moves up (count > 0) or down (count < 0)
+static void shiftRangesAfter(GeometryPool &pool, const Uint32 &range, const int &count) {
+	const Uint32 distance { static_cast<Uint32>(std::abs(count)) };
+	if (count > 0) {
+		// the last range moves first, into the space just grown at the end of the order
+		for (Uint32 later = static_cast<Uint32>(pool.material_ranges.size()) - 1; later > range; --later) {
+			PoolMaterialRange &moved { pool.material_ranges[later] };
+			const Uint32 num_moved { SDL_min(distance, moved.num_commands) };
+			const Uint32 destination { moved.first_command + moved.num_commands + distance - num_moved };
+			for (Uint32 i = 0; i < num_moved; ++i) {
+				setOrder(pool, destination + i, pool.cpu_order[moved.first_command + i]);
+			}
+			moved.first_command += distance;
+		}
+	} else {
+		// the first range moves first, into the space freed at the end of the given range
+		for (Uint32 later = range + 1; later < pool.material_ranges.size(); ++later) {
+			PoolMaterialRange &moved { pool.material_ranges[later] };
+			const Uint32 num_moved { SDL_min(distance, moved.num_commands) };
+			const Uint32 source { moved.first_command + moved.num_commands - num_moved };
+			for (Uint32 i = 0; i < num_moved; ++i) {
+				setOrder(pool, moved.first_command - distance + i, pool.cpu_order[source + i]);
+			}
+			moved.first_command -= distance;
+		}
+	}
+}
+
+static void spliceIn(GeometryPool &pool, const OrderSplice &splice) {
+	std::vector<PoolMaterialRange>::iterator found { std::lower_bound(pool.material_ranges.begin(), pool.material_ranges.end(), materialKey(splice.material),
+			[](const PoolMaterialRange &range, const auto &key) { return materialKey(range.material) < key; }) };
+	if (found == pool.material_ranges.end() || found->material != splice.material) {
+		const Uint32 first_command { found == pool.material_ranges.end() ? static_cast<Uint32>(pool.cpu_order.size()) : found->first_command };
+		found = pool.material_ranges.insert(found, { splice.material, first_command, 0 });
+	}
+	const Uint32 range { static_cast<Uint32>(found - pool.material_ranges.begin()) };
+	pool.cpu_order.resize(pool.cpu_order.size() + splice.num_draws);
+	shiftRangesAfter(pool, range, static_cast<int>(splice.num_draws));
+	PoolMaterialRange &grown { pool.material_ranges[range] };
+	for (Uint32 i = 0; i < splice.num_draws; ++i) {
+		setOrder(pool, grown.first_command + grown.num_commands + i, splice.first_draw + i);
+	}
+	grown.num_commands += splice.num_draws;
+}
+
+static void spliceOut(GeometryPool &pool, const OrderSplice &splice) {
+	const std::vector<PoolMaterialRange>::iterator found { std::lower_bound(pool.material_ranges.begin(), pool.material_ranges.end(), materialKey(splice.material),
+			[](const PoolMaterialRange &range, const auto &key) { return materialKey(range.material) < key; }) };
+	if (found == pool.material_ranges.end() || found->material != splice.material) { return; }
+	const Uint32 range { static_cast<Uint32>(found - pool.material_ranges.begin()) };
+	// the last command of the range takes the place of each removed one
+	for (Uint32 slot = splice.first_draw; slot < splice.first_draw + splice.num_draws; ++slot) {
+		PoolMaterialRange &shrunk { pool.material_ranges[range] };
+		const Uint32 last { shrunk.first_command + shrunk.num_commands - 1 };
+		const Uint32 position { pool.order_positions[slot] };
+		if (position != last) { setOrder(pool, position, pool.cpu_order[last]); }
+		--shrunk.num_commands;
+	}
+	shiftRangesAfter(pool, range, -static_cast<int>(splice.num_draws));
+	pool.cpu_order.resize(pool.cpu_order.size() - splice.num_draws);
+	if (!pool.material_ranges[range].num_commands) { pool.material_ranges.erase(pool.material_ranges.begin() + range); }
+}
+
+void Scene::sortDraws() {
+	for (Uint32 pool_index = 0; pool_index < m_pools.size(); ++pool_index) {
+		GeometryPool &pool { m_pools[pool_index] };
+		if (pool.order_positions.size() < pool.cpu_draws.size()) {
+			pool.order_positions.resize(pool.cpu_draws.size());
+		}
+		if (pool.order_dirty) {
+			rebuildOrder(pool_index);
+		} else {
+			for (const OrderSplice &splice : pool.splices) {
+				if (splice.removed) {
+					spliceOut(pool, splice);
+				} else {
+					spliceIn(pool, splice);
+				}
+			}
+		}
+		if (!pool.splices.empty() || pool.order_dirty) { pool.order_pending = true; }
+		pool.splices.clear();
+		pool.order_dirty = false;
+	}
+}
+
+void Scene::rebuildOrder(const Uint32 &pool_index) {
+	GeometryPool &pool { m_pools[pool_index] };
+	// slot ranges of every asset in the pool, equal materials end up next to each other
+	struct SlotRange {
+		const Material *material;
+		Uint32 first_draw, num_draws;
+	};
+	// only runs after the order couldn't be uploaded, may run beside jobs using the frame arena
+	std::vector<SlotRange> slot_ranges;
+	for (const std::pair<const AssetHandle, Asset> &entry : m_assets) {
+		const Asset &asset { entry.second };
+		if (asset.pool != pool_index) { continue; }
+		for (const MaterialRange &range : asset.material_ranges) {
+			slot_ranges.push_back({ &asset.materials[range.material], range.first_draw, range.num_draws });
+		}
+	}
+	std::sort(slot_ranges.begin(), slot_ranges.end(), [](const SlotRange &a, const SlotRange &b) {
+		return std::tuple_cat(materialKey(*a.material), std::tuple { a.first_draw }) < std::tuple_cat(materialKey(*b.material), std::tuple { b.first_draw });
+	});
+
+	pool.material_ranges.clear();
+	pool.cpu_order.clear();
+	pool.order_changes.clear();
+	for (const SlotRange &range : slot_ranges) {
+		if (pool.material_ranges.empty() || pool.material_ranges.back().material != *range.material) {
+			pool.material_ranges.push_back({ *range.material, static_cast<Uint32>(pool.cpu_order.size()), 0 });
+		}
+		for (Uint32 draw = range.first_draw; draw < range.first_draw + range.num_draws; ++draw) {
+			pool.order_positions[draw] = static_cast<Uint32>(pool.cpu_order.size());
+			pool.order_changes.push_back(static_cast<Uint32>(pool.cpu_order.size()));
+			pool.cpu_order.push_back(draw);
+		}
+		pool.material_ranges.back().num_commands += range.num_draws;
+	}
+}
+
+void Scene::upload(SDL_GPUCommandBuffer *cmdbuf, FrameArena &frame) {
+	const bool textures_pending { texturesPending() };
+	// callers that don't run the stages on workers get them here
+	if (std::any_of(m_pools.begin(), m_pools.end(), [](const GeometryPool &pool) { return pool.order_dirty || !pool.splices.empty(); })) { sortDraws(); }
+	if (!m_instances_computed) { updateTransforms(); }
+	const bool orders_pending { std::any_of(m_pools.begin(), m_pools.end(), [](const GeometryPool &pool) { return pool.order_pending; }) };
+	const bool commands_pending { std::any_of(m_pools.begin(), m_pools.end(), [](const GeometryPool &pool) { return pool.commands_pending; }) };
+	if (m_dirty_instances.empty() && !textures_pending && !orders_pending && !commands_pending && !m_visibility_dirty) { return; }
+	SDL_GPUCopyPass *copypass { SDL_BeginGPUCopyPass(cmdbuf) };
+	uploadInstances(copypass);
+	uploadVisibility(copypass);
+	if (orders_pending) { uploadOrders(copypass); }
+	if (commands_pending) { uploadCommands(copypass); }
+	if (textures_pending) { streamTextures(copypass, frame); }
+	SDL_EndGPUCopyPass(copypass);
+}
+
+void Scene::uploadOrders(SDL_GPUCopyPass *copypass) {
+	for (GeometryPool &pool : m_pools) {
+		if (!pool.order_pending) { continue; }
+		pool.order_pending = false;
+		// entries past the end were moved down or removed
+		std::vector<Uint32> &changes { pool.order_changes };
+		std::sort(changes.begin(), changes.end());
+		changes.erase(std::unique(changes.begin(), changes.end()), changes.end());
+		changes.erase(std::lower_bound(changes.begin(), changes.end(), static_cast<Uint32>(pool.cpu_order.size())), changes.end());
+		if (changes.empty()) { continue; }
+		// an order that outgrows its buffer is written whole into a new one, nothing to copy over
+		const Uint32 order_bytes { static_cast<Uint32>(pool.cpu_order.size() * sizeof(Uint32)) };
+		const bool whole { order_bytes > pool.order.size() };
+		const Uint32 upload_bytes { whole ? order_bytes : static_cast<Uint32>(changes.size() * sizeof(Uint32)) };
+		GPUResource<TRANSFER_BUFFER> transfer_buf;
+		transfer_buf.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = upload_bytes,
+		};
+		Uint32 *order_data { nullptr };
+		if (pool.order.reserve(m_gpu, nullptr, order_bytes) && transfer_buf.create(m_gpu)) {
+			order_data = static_cast<Uint32*>(SDL_MapGPUTransferBuffer(m_gpu, transfer_buf.get(), false));
+			if (!order_data) { SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MapGPUTransferBuffer failed:\n\t%s", SDL_GetError()); }
+		}
+		if (!order_data) {
+			if (transfer_buf.get()) { transfer_buf.release(); }
+			// the gpu order is out of date, nothing of the pool is drawn until all of it is uploaded
+			pool.cpu_order.clear();
+			pool.material_ranges.clear();
+			pool.order_changes.clear();
+			pool.order_dirty = true;
+			continue;
+		}
+		if (whole) {
+			SDL_memcpy(order_data, pool.cpu_order.data(), order_bytes);
+			SDL_UnmapGPUTransferBuffer(m_gpu, transfer_buf.get());
+			// frames in flight keep reading the old order
+			const SDL_GPUTransferBufferLocation location { transfer_buf.get(), 0 };
+			const SDL_GPUBufferRegion region { pool.order.get(), 0, order_bytes };
+			SDL_UploadToGPUBuffer(copypass, &location, &region, true);
+		} else {
+			for (Uint32 i = 0; i < changes.size(); ++i) {
+				order_data[i] = pool.cpu_order[changes[i]];
+			}
+			SDL_UnmapGPUTransferBuffer(m_gpu, transfer_buf.get());
+			// one upload per run of consecutive changed entries
+			for (Uint32 begin = 0, end = 1; begin < changes.size(); begin = end++) {
+				while (end < changes.size() && changes[end] == changes[end - 1] + 1) { ++end; }
+				const SDL_GPUTransferBufferLocation location { transfer_buf.get(), begin * static_cast<Uint32>(sizeof(Uint32)) };
+				const SDL_GPUBufferRegion region { pool.order.get(), changes[begin] * static_cast<Uint32>(sizeof(Uint32)), (end - begin) * static_cast<Uint32>(sizeof(Uint32)) };
+				SDL_UploadToGPUBuffer(copypass, &location, &region, false);
+			}
+		}
+		changes.clear();
+		transfer_buf.release();
+	}
+}
+
+void Scene::uploadCommands(SDL_GPUCopyPass *copypass) {
+	Uint32 command_bytes { 0 };
+	for (const GeometryPool &pool : m_pools) {
+		if (pool.commands_pending) { command_bytes += static_cast<Uint32>(pool.cpu_commands.size() * sizeof(SDL_GPUIndexedIndirectDrawCommand)); }
+	}
+	if (!m_command_transfer_buf.get() || m_command_transfer_buf.info.size < command_bytes) {
+		if (m_command_transfer_buf.get()) { m_command_transfer_buf.release(); }
+		m_command_transfer_buf.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = command_bytes,
+		};
+		if (!m_command_transfer_buf.create(m_gpu)) { return; }
+	}
+	// cycle, the previous frame's commands may still be in flight
+	Uint8 *command_data { static_cast<Uint8*>(SDL_MapGPUTransferBuffer(m_gpu, m_command_transfer_buf.get(), true)) };
+	Uint32 offset { 0 };
+	for (GeometryPool &pool : m_pools) {
+		if (!pool.commands_pending) { continue; }
+		pool.commands_pending = false;
+		const Uint32 bytes { static_cast<Uint32>(pool.cpu_commands.size() * sizeof(SDL_GPUIndexedIndirectDrawCommand)) };
+		SDL_memcpy(command_data + offset, pool.cpu_commands.data(), bytes);
+		const SDL_GPUTransferBufferLocation location { m_command_transfer_buf.get(), offset };
+		const SDL_GPUBufferRegion region { pool.commands.get(), 0, bytes };
+		// every command is rewritten, as the cull shader does
+		SDL_UploadToGPUBuffer(copypass, &location, &region, true);
+		offset += bytes;
+	}
+	SDL_UnmapGPUTransferBuffer(m_gpu, m_command_transfer_buf.get());
+}
+
+void Scene::uploadInstances(SDL_GPUCopyPass *copypass) {
+	if (m_dirty_instances.empty()) { return; }
+	Uint32 instance_count { 0 };
+	for (const std::pair<Uint32, Uint32> &range : m_dirty_instances) {
+		instance_count += range.second;
+	}
+	const Uint32 instance_bytes { instance_count * static_cast<Uint32>(sizeof(GPUInstance)) };
+	// reuse the transfer buffer across uploads, grow it when more meshes change at once
+	if (!m_instance_transfer_buf.get() || m_instance_transfer_buf.info.size < instance_bytes) {
+		if (m_instance_transfer_buf.get()) { m_instance_transfer_buf.release(); }
+		m_instance_transfer_buf.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = instance_bytes,
+		};
+		if (!m_instance_transfer_buf.create(m_gpu)) { return; }
+	}
+	// cycle, the previous upload may still be in flight
+	GPUInstance *instance_data { static_cast<GPUInstance*>(SDL_MapGPUTransferBuffer(m_gpu, m_instance_transfer_buf.get(), true)) };
+	Uint32 offset { 0 };
+	for (const std::pair<Uint32, Uint32> &range : m_dirty_instances) {
+		SDL_memcpy(instance_data + offset, m_models.data() + range.first, range.second * sizeof(GPUInstance));
+		offset += range.second;
+	}
+	SDL_UnmapGPUTransferBuffer(m_gpu, m_instance_transfer_buf.get());
+	offset = 0;
+	for (const std::pair<Uint32, Uint32> &range : m_dirty_instances) {
+		const SDL_GPUTransferBufferLocation location {
+			.transfer_buffer = m_instance_transfer_buf.get(),
+			.offset = offset * static_cast<Uint32>(sizeof(GPUInstance))
+		};
+		const SDL_GPUBufferRegion region {
+			m_instances.get(),
+			range.first * static_cast<Uint32>(sizeof(GPUInstance)),
+			range.second * static_cast<Uint32>(sizeof(GPUInstance))
+		};
+		SDL_UploadToGPUBuffer(copypass, &location, &region, false);
+		offset += range.second;
+	}
+	m_dirty_instances.clear();
+	m_instances_computed = false;
+}
+
+void Scene::uploadVisibility(SDL_GPUCopyPass *copypass) {
+	if (!m_visibility_dirty || m_visibility_bits.empty()) { return; }
+	const Uint32 bytes { static_cast<Uint32>(m_visibility_bits.size() * sizeof(Uint32)) };
+	// the whole mask is rewritten, nothing to keep when it grows
+	if (!m_visibility.reserve(m_gpu, nullptr, bytes)) { return; }
+	if (!m_visibility_transfer_buf.get() || m_visibility_transfer_buf.info.size < bytes) {
+		if (m_visibility_transfer_buf.get()) { m_visibility_transfer_buf.release(); }
+		m_visibility_transfer_buf.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = bytes,
+		};
+		if (!m_visibility_transfer_buf.create(m_gpu)) { return; }
+	}
+	// cycle, the previous frame's mask may still be in flight
+	void *mask { SDL_MapGPUTransferBuffer(m_gpu, m_visibility_transfer_buf.get(), true) };
+	SDL_memcpy(mask, m_visibility_bits.data(), bytes);
+	SDL_UnmapGPUTransferBuffer(m_gpu, m_visibility_transfer_buf.get());
+	const SDL_GPUTransferBufferLocation location { m_visibility_transfer_buf.get(), 0 };
+	const SDL_GPUBufferRegion region { m_visibility.get(), 0, bytes };
+	SDL_UploadToGPUBuffer(copypass, &location, &region, true);
+	m_visibility_dirty = false;
+}
+
+bool Scene::texturesPending() const {
+	for (const std::pair<const Uint32, std::unique_ptr<StreamedTexture>> &entry : m_textures) {
+		const StreamedTexture &texture { *entry.second };
+		if (!texture.transcode || !texture.transcode->done || texture.failed) { continue; }
+		if (!texture.texture.get() || texture.resident_level > 0) { return true; }
+	}
+	return false;
+}
+
+void Scene::streamTextures(SDL_GPUCopyPass *copypass, FrameArena &frame) {
+	// (texture, level) pairs to upload this frame
+	std::pmr::vector<std::pair<StreamedTexture*, Uint32>> uploads { &frame };
+	Uint32 total_bytes { 0 };
+	for (std::pair<const Uint32, std::unique_ptr<StreamedTexture>> &entry : m_textures) {
+		StreamedTexture &texture { *entry.second };
+		if (!texture.transcode || !texture.transcode->done || texture.failed || texture.resident_level == 0) { continue; }
+		if (!texture.texture.get()) {
+			texture.texture.info = {
+				.type = SDL_GPU_TEXTURETYPE_2D,
+				.format = m_texture_format,
+				.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+				.width = texture.width,
+				.height = texture.height,
+				.layer_count_or_depth = 1,
+				.num_levels = static_cast<Uint32>(texture.levels.size()),
+			};
+			if (!texture.texture.create(m_gpu)) {
+				texture.failed = true;
+				continue;
+			}
+			for (const std::vector<Uint8> &level : texture.levels) {
+				texture.bytes += level.size();
+			}
+			m_texture_bytes += texture.bytes;
+		}
+		// coarsest levels first, a level larger than the budget goes alone so streaming can't stall
+		while (texture.resident_level > 0) {
+			const Uint32 level { texture.resident_level - 1 };
+			const Uint32 level_bytes { static_cast<Uint32>(texture.levels[level].size()) };
+			if (total_bytes + level_bytes > stream_budget_bytes && !uploads.empty()) { break; }
+			uploads.emplace_back(&texture, level);
+			total_bytes += level_bytes;
+			--texture.resident_level;
+			if (total_bytes >= stream_budget_bytes) { break; }
+		}
+		if (total_bytes >= stream_budget_bytes) { break; }
+	}
+	if (uploads.empty()) { return; }
+
+	const Uint32 transfer_bytes { SDL_max(total_bytes, stream_budget_bytes) };
+	if (!m_texture_transfer_buf.get() || m_texture_transfer_buf.info.size < transfer_bytes) {
+		if (m_texture_transfer_buf.get()) { m_texture_transfer_buf.release(); }
+		m_texture_transfer_buf.info = {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+			.size = transfer_bytes,
+		};
+		if (!m_texture_transfer_buf.create(m_gpu)) {
+			// try again next frame
+			for (const std::pair<StreamedTexture*, Uint32> &upload : uploads) {
+				upload.first->resident_level = SDL_max(upload.first->resident_level, upload.second + 1);
+			}
+			return;
+		}
+	}
+	// cycle, the previous frame's levels may still be in flight
+	Uint8 *transfer_data { static_cast<Uint8*>(SDL_MapGPUTransferBuffer(m_gpu, m_texture_transfer_buf.get(), true)) };
+	Uint32 offset { 0 };
+	for (const std::pair<StreamedTexture*, Uint32> &upload : uploads) {
+		std::vector<Uint8> &level { upload.first->levels[upload.second] };
+		SDL_memcpy(transfer_data + offset, level.data(), level.size());
+		const SDL_GPUTextureTransferInfo source {
+			.transfer_buffer = m_texture_transfer_buf.get(),
+			.offset = offset,
+		};
+		const SDL_GPUTextureRegion destination {
+			.texture = upload.first->texture.get(),
+			.mip_level = upload.second,
+			.w = SDL_max(1u, upload.first->width >> upload.second),
+			.h = SDL_max(1u, upload.first->height >> upload.second),
+			.d = 1,
+		};
+		SDL_UploadToGPUTexture(copypass, &source, &destination, false);
+		offset += static_cast<Uint32>(level.size());
+		// the gpu copy is all that's kept of the level
+		std::vector<Uint8>().swap(level);
+	}
+	SDL_UnmapGPUTransferBuffer(m_gpu, m_texture_transfer_buf.get());
+	++m_revision;
+
+	// the asset is drawn textured from this frame on
+	for (const std::pair<StreamedTexture*, Uint32> &upload : uploads) {
+		const std::unordered_map<AssetHandle, Asset>::iterator asset { m_assets.find(upload.first->asset) };
+		if (asset != m_assets.end() && !asset->second.textured) {
+			asset->second.textured = true;
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s textured %.2f ms after it started loading",
+					asset->second.name.c_str(), (SDL_GetTicksNS() - asset->second.load_start) / 1e6);
+		}
+		if (upload.second == 0) {
+			SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Texture %ux%u resident, textures use %.2f MiB, geometry %.2f MiB",
+					upload.first->width, upload.first->height, m_texture_bytes / 1048576.0, geometryBytes() / 1048576.0);
+		}
+	}
+}
+
+const StreamedTexture* Scene::texture(const Uint32 &id) const {
+	const std::unordered_map<Uint32, std::unique_ptr<StreamedTexture>>::const_iterator found { m_textures.find(id) };
+	if (found == m_textures.end()) { return nullptr; }
+	const StreamedTexture &texture { *found->second };
+	if (!texture.texture.get() || texture.resident_level >= texture.levels.size()) { return nullptr; }
+	return &texture;
+}
+
+Uint64 Scene::geometryBytes() const {
+	Uint64 bytes { m_instances.size() + m_instance_ids.size() + m_visibility.size() };
+	for (const GeometryPool &pool : m_pools) {
+		bytes += pool.indices.size() + pool.verts.size() + pool.norms.size() + pool.uvs.size() + pool.draws.size() + pool.commands.size() + pool.order.size();
+	}
+	return bytes;
+}
+
+void Scene::releaseTexture(const Uint32 &id) {
+	const std::unordered_map<Uint32, std::unique_ptr<StreamedTexture>>::iterator found { m_textures.find(id) };
+	if (found == m_textures.end()) { return; }
+	StreamedTexture &texture { *found->second };
+	if (texture.transcode) { m_jobs->wait(texture.transcode); }
+	if (texture.texture.get()) {
+		m_texture_bytes -= texture.bytes;
+		texture.texture.release();
+	}
+	m_textures.erase(found);
+}
@@ -5,15 +5,73 @@
 #include <SDL3/SDL_init.h>
 #include <SDL3/SDL_log.h>
 #include "App.hpp"
+#include "Benchmarks.hpp"
 
 App ctx;
 
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char* argv[]) {
+	// headless benchmarks exit before a window is created
+	std::filesystem::path capture_directory;
+	std::optional<SceneBenchmark> scene_benchmark;
+	std::vector<std::filesystem::path> cull_scenes;
+	for (int i = 1; i < argc; ++i) {
+		if (SDL_strcmp(argv[i], "--bench-bvh") == 0) {
+			return benchmarkBVH() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+		}
+		if (SDL_strcmp(argv[i], "--bench-jobs") == 0) {
+			return benchmarkJobs() ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+		}
+		if (SDL_strcmp(argv[i], "--bench-cull") == 0) {
+			// every scene up to the next option
+			while (i + 1 < argc && SDL_strncmp(argv[i + 1], "--", 2) != 0) {
+				cull_scenes.emplace_back(argv[++i]);
+			}
+			continue;
+		}
+		if (SDL_strcmp(argv[i], "--update-baseline") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->update_baseline = true;
+			continue;
+		}
+		if (SDL_strcmp(argv[i], "--compare-log-priority") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->compare_log_priority = true;
+			continue;
+		}
+		// the rest take a value
+		if (i + 1 >= argc) { continue; }
+		if (SDL_strcmp(argv[i], "--capture") == 0) {
+			capture_directory = argv[++i];
+		} else if (SDL_strcmp(argv[i], "--bench") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->scene = argv[++i];
+		} else if (SDL_strcmp(argv[i], "--baseline") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->baseline = argv[++i];
+		} else if (SDL_strcmp(argv[i], "--frames") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->frames = static_cast<Uint32>(SDL_strtoul(argv[++i], nullptr, 10));
+		} else if (SDL_strcmp(argv[i], "--threshold") == 0) {
+			if (!scene_benchmark) { scene_benchmark.emplace(); }
+			scene_benchmark->threshold = static_cast<float>(SDL_atof(argv[++i]));
+		}
+	}
+	if (!cull_scenes.empty()) {
+		const Uint32 frames { scene_benchmark ? scene_benchmark->frames : SceneBenchmark { }.frames };
+		return benchmarkCulling(cull_scenes, frames) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
+	if (scene_benchmark) {
+		if (scene_benchmark->scene.empty()) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: --bench scene.glb [--baseline results.txt] [--frames N] [--threshold 0.2] [--update-baseline] [--compare-log-priority]");
+			return SDL_APP_FAILURE;
+		}
+		return benchmarkScene(scene_benchmark.value()) ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	}
 	if (!SDL_Init(SDL_INIT_VIDEO)) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init failed:\n\t%s", SDL_GetError());
 		return SDL_APP_FAILURE;
 	}
-	if (ctx.init() != 0) { return SDL_APP_FAILURE; }
+	if (ctx.init({ .capture_directory = capture_directory }) != 0) { return SDL_APP_FAILURE; }
 	*appstate = &ctx;
 	return SDL_APP_CONTINUE;
 }
@@ -42,5 +100,7 @@ SDL_AppResult SDL_AppEvent(void* appstate, SDL_Event* event) {
 
 void SDL_AppQuit(void* appstate, SDL_AppResult result) {
 	App *ctx { static_cast<App*>(appstate) };
+	// appstate is only set once init succeeded
+	if (!ctx) { return; }
 	ctx->quit();
 }
@@ -0,0 +1,222 @@
+// Writes synthetic glb files for benchmarks
+// every node instances one of a set of unique meshes, nodes form a hierarchy of a given depth,
+// meshes are spheres tessellated to a triangle count with positions, normals & 16 or 32 bit indices.
+//
+// scenegen --out scene.glb [--nodes N] [--meshes M] [--triangles T] [--depth D] [--index-width 16|32] [--seed S]
+#include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+struct SceneParams {
+	Uint32 nodes { 1000 };
+	Uint32 meshes { 16 };
+	Uint32 triangles { 1024 }; // per mesh, rounded up to whole rows of the sphere
+	Uint32 depth { 4 }; // levels of the hierarchy, 1 -> every node is a root
+	Uint32 index_width { 16 };
+	Uint32 seed { 1 };
+	std::string out;
+};
+
+// geometry of one mesh, tightly packed as it is written to the binary chunk
+struct MeshData {
+	std::vector<float> positions, normals; // 3 per vertex
+	std::vector<Uint32> indices;
+	float min[3], max[3];
+};
+
+// a sphere of stacks * slices quads, each mesh gets its own bumps so no two are alike
+static MeshData sphere(const Uint32 &triangles, std::mt19937 &rng) {
+	const Uint32 quads { SDL_max((triangles + 1) / 2, 2u) };
+	const Uint32 slices { SDL_max(static_cast<Uint32>(std::ceil(std::sqrt(quads * 2.0))), 3u) };
+	const Uint32 stacks { SDL_max((quads + slices - 1) / slices, 2u) };
+	std::uniform_real_distribution<float> frequency { 2.0f, 8.0f }, amplitude { 0.0f, 0.15f };
+	const float bump_frequency { frequency(rng) }, bump_amplitude { amplitude(rng) };
+	MeshData mesh;
+	for (Uint32 i = 0; i < 3; ++i) {
+		mesh.min[i] = std::numeric_limits<float>::max();
+		mesh.max[i] = std::numeric_limits<float>::lowest();
+	}
+	for (Uint32 stack = 0; stack <= stacks; ++stack) {
+		const float phi { SDL_PI_F * stack / stacks };
+		for (Uint32 slice = 0; slice <= slices; ++slice) {
+			const float theta { 2.0f * SDL_PI_F * slice / slices };
+			// the normal is the unbumped sphere's, close enough for shading
+			const float normal[3] { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+			const float radius { 1.0f + bump_amplitude * std::sin(bump_frequency * theta) * std::sin(bump_frequency * phi) };
+			for (Uint32 i = 0; i < 3; ++i) {
+				const float position { normal[i] * radius };
+				mesh.positions.push_back(position);
+				mesh.normals.push_back(normal[i]);
+				mesh.min[i] = SDL_min(mesh.min[i], position);
+				mesh.max[i] = SDL_max(mesh.max[i], position);
+			}
+		}
+	}
+	// counter clockwise seen from outside
+	for (Uint32 stack = 0; stack < stacks; ++stack) {
+		for (Uint32 slice = 0; slice < slices; ++slice) {
+			const Uint32 a { stack * (slices + 1) + slice }, b { a + slices + 1 };
+			mesh.indices.insert(mesh.indices.end(), { a, a + 1, b, a + 1, b + 1, b });
+		}
+	}
+	return mesh;
+}
+
+static bool parse(int argc, char *argv[], SceneParams &params) {
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg { argv[i] };
+		if (i + 1 >= argc) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s needs a value", arg.c_str());
+			return false;
+		}
+		const char *value { argv[++i] };
+		if (arg == "--out") {
+			params.out = value;
+			continue;
+		}
+		const Uint32 number { static_cast<Uint32>(SDL_strtoul(value, nullptr, 10)) };
+		if (arg == "--nodes") { params.nodes = number; }
+		else if (arg == "--meshes") { params.meshes = number; }
+		else if (arg == "--triangles") { params.triangles = number; }
+		else if (arg == "--depth") { params.depth = number; }
+		else if (arg == "--index-width") { params.index_width = number; }
+		else if (arg == "--seed") { params.seed = number; }
+		else {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown option %s", arg.c_str());
+			return false;
+		}
+	}
+	if (params.out.empty() || !params.nodes || !params.meshes || !params.depth || (params.index_width != 16 && params.index_width != 32)) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Usage: scenegen --out scene.glb [--nodes N] [--meshes M] [--triangles T] [--depth D] [--index-width 16|32] [--seed S]");
+		return false;
+	}
+	return true;
+}
+
+static void append(std::vector<Uint8> &bin, const void *data, const std::size_t &size) {
+	const Uint8 *bytes { static_cast<const Uint8*>(data) };
+	bin.insert(bin.end(), bytes, bytes + size);
+	// every view starts 4 byte aligned
+	bin.resize((bin.size() + 3) & ~std::size_t { 3 }, 0);
+}
+
+int main(int argc, char *argv[]) {
+	SceneParams params;
+	if (!parse(argc, argv, params)) { return 1; }
+	std::mt19937 rng { params.seed };
+
+	std::vector<Uint8> bin;
+	std::string meshes, accessors, views;
+	for (Uint32 m = 0; m < params.meshes; ++m) {
+		const MeshData mesh { sphere(params.triangles, rng) };
+		const Uint32 vertex_count { static_cast<Uint32>(mesh.positions.size() / 3) };
+		if (params.index_width == 16 && vertex_count > 65536) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%u vertices don't fit 16 bit indices, use --index-width 32", vertex_count);
+			return 1;
+		}
+		const Uint32 view { m * 3 }, accessor { m * 3 };
+		const std::size_t index_offset { bin.size() };
+		if (params.index_width == 16) {
+			std::vector<Uint16> narrow(mesh.indices.begin(), mesh.indices.end());
+			append(bin, narrow.data(), narrow.size() * sizeof(Uint16));
+		} else {
+			append(bin, mesh.indices.data(), mesh.indices.size() * sizeof(Uint32));
+		}
+		const std::size_t position_offset { bin.size() };
+		append(bin, mesh.positions.data(), mesh.positions.size() * sizeof(float));
+		const std::size_t normal_offset { bin.size() };
+		append(bin, mesh.normals.data(), mesh.normals.size() * sizeof(float));
+
+		const std::size_t index_bytes { mesh.indices.size() * params.index_width / 8 };
+		const std::size_t attribute_bytes { mesh.positions.size() * sizeof(float) };
+		views += (m ? "," : "") + std::string("{\"buffer\":0,\"byteOffset\":") + std::to_string(index_offset) +
+			",\"byteLength\":" + std::to_string(index_bytes) + ",\"target\":34963}" +
+			",{\"buffer\":0,\"byteOffset\":" + std::to_string(position_offset) + ",\"byteLength\":" + std::to_string(attribute_bytes) + ",\"target\":34962}" +
+			",{\"buffer\":0,\"byteOffset\":" + std::to_string(normal_offset) + ",\"byteLength\":" + std::to_string(attribute_bytes) + ",\"target\":34962}";
+		auto vec3 = [](const float value[3]) {
+			return "[" + std::to_string(value[0]) + "," + std::to_string(value[1]) + "," + std::to_string(value[2]) + "]";
+		};
+		accessors += (m ? "," : "") + std::string("{\"bufferView\":") + std::to_string(view) +
+			",\"componentType\":" + (params.index_width == 16 ? "5123" : "5125") + ",\"count\":" + std::to_string(mesh.indices.size()) + ",\"type\":\"SCALAR\"}" +
+			",{\"bufferView\":" + std::to_string(view + 1) + ",\"componentType\":5126,\"count\":" + std::to_string(vertex_count) +
+			",\"type\":\"VEC3\",\"min\":" + vec3(mesh.min) + ",\"max\":" + vec3(mesh.max) + "}" +
+			",{\"bufferView\":" + std::to_string(view + 2) + ",\"componentType\":5126,\"count\":" + std::to_string(vertex_count) + ",\"type\":\"VEC3\"}";
+		meshes += (m ? "," : "") + std::string("{\"primitives\":[{\"attributes\":{\"POSITION\":") + std::to_string(accessor + 1) +
+			",\"NORMAL\":" + std::to_string(accessor + 2) + "},\"indices\":" + std::to_string(accessor) + ",\"mode\":4}]}";
+	}
+
+	// the first depth nodes form a chain so the hierarchy is as deep as asked,
+	// the rest hang off random nodes above the last level
+	std::vector<Uint32> level(params.nodes);
+	std::vector<std::vector<Uint32>> children(params.nodes);
+	std::vector<Uint32> parents; // nodes that can take children
+	std::vector<Uint32> roots;
+	for (Uint32 n = 0; n < params.nodes; ++n) {
+		if (n < params.depth && n > 0) {
+			level[n] = n;
+			children[n - 1].push_back(n);
+		} else if (n >= params.depth && !parents.empty()) {
+			const Uint32 parent { parents[std::uniform_int_distribution<std::size_t> { 0, parents.size() - 1 }(rng)] };
+			level[n] = level[parent] + 1;
+			children[parent].push_back(n);
+		} else {
+			roots.push_back(n);
+		}
+		if (level[n] + 1 < params.depth) { parents.push_back(n); }
+	}
+	// children sit around their parent, the spread keeps the density about the same for any count
+	const float spread { 4.0f * std::cbrt(static_cast<float>(params.nodes)) };
+	std::uniform_real_distribution<float> offset { -spread, spread };
+	std::string nodes;
+	for (Uint32 n = 0; n < params.nodes; ++n) {
+		const float scale { 1.0f / (level[n] + 1) };
+		nodes += (n ? "," : "") + std::string("{\"mesh\":") + std::to_string(n % params.meshes) +
+			",\"translation\":[" + std::to_string(offset(rng) * scale) + "," + std::to_string(offset(rng) * scale) + "," + std::to_string(offset(rng) * scale) + "]";
+		if (!children[n].empty()) {
+			nodes += ",\"children\":[";
+			for (Uint32 c = 0; c < children[n].size(); ++c) {
+				nodes += (c ? "," : "") + std::to_string(children[n][c]);
+			}
+			nodes += "]";
+		}
+		nodes += "}";
+	}
+	std::string scene_nodes;
+	for (Uint32 r = 0; r < roots.size(); ++r) {
+		scene_nodes += (r ? "," : "") + std::to_string(roots[r]);
+	}
+
+	std::string json { "{\"asset\":{\"version\":\"2.0\",\"generator\":\"scenegen\"},\"scene\":0,\"scenes\":[{\"nodes\":[" + scene_nodes + "]}]" +
+		",\"nodes\":[" + nodes + "],\"meshes\":[" + meshes + "],\"accessors\":[" + accessors + "],\"bufferViews\":[" + views + "]" +
+		",\"buffers\":[{\"byteLength\":" + std::to_string(bin.size()) + "}]}" };
+	// the json chunk is padded with spaces to 4 bytes
+	json.resize((json.size() + 3) & ~std::size_t { 3 }, ' ');
+
+	std::vector<Uint8> glb;
+	auto appendU32 = [&](const Uint32 &value) {
+		const Uint8 *bytes { reinterpret_cast<const Uint8*>(&value) };
+		glb.insert(glb.end(), bytes, bytes + sizeof(value));
+	};
+	appendU32(0x46546C67); // "glTF"
+	appendU32(2);
+	appendU32(static_cast<Uint32>(12 + 8 + json.size() + 8 + bin.size()));
+	appendU32(static_cast<Uint32>(json.size()));
+	appendU32(0x4E4F534A); // "JSON"
+	glb.insert(glb.end(), json.begin(), json.end());
+	appendU32(static_cast<Uint32>(bin.size()));
+	appendU32(0x004E4942); // "BIN"
+	glb.insert(glb.end(), bin.begin(), bin.end());
+	if (!SDL_SaveFile(params.out.c_str(), glb.data(), glb.size())) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Can't write %s\n\t%s", params.out.c_str(), SDL_GetError());
+		return 1;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Wrote %s: %u nodes (%zu roots), %u meshes, %zu bytes",
+			params.out.c_str(), params.nodes, roots.size(), params.meshes, glb.size());
+	return 0;
+}